@@ -0,0 +1,468 @@
+#ifndef BASIC_BIG_INTEGER_H
+#define BASIC_BIG_INTEGER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "big_integer.h"
+
+// Sign-magnitude integer over limbs of type Limb (uint32_t or uint64_t).
+// Digits are kept in a plain std::vector, the kernels work on double-width
+// intermediates: uint64_t for 32-bit limbs and unsigned __int128 for 64-bit ones,
+// so basic_big_integer<uint64_t> runs half as many loop iterations as big_integer.
+// Converts to and from big_integer; see the "limb" suite of big_integer_benchmark.
+namespace wide_limbs {
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    template<typename Limb>
+    struct limb_traits;
+
+    template<>
+    struct limb_traits<uint32_t> {
+        typedef uint64_t wide;
+
+        static unsigned clz(uint32_t x) {
+            return static_cast<unsigned>(__builtin_clz(x));
+        }
+    };
+
+    template<>
+    struct limb_traits<uint64_t> {
+        typedef uint128_t wide;
+
+        static unsigned clz(uint64_t x) {
+            return static_cast<unsigned>(__builtin_clzll(x));
+        }
+    };
+
+    // Same contracts as the kernels of limb_ops.h, for any limb type
+    template<typename Limb>
+    Limb add_n(Limb *r, Limb const *a, Limb const *b, size_t n) {
+        typedef typename limb_traits<Limb>::wide wide;
+        Limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            wide s = wide(a[i]) + b[i] + carry;
+            r[i] = static_cast<Limb>(s);
+            carry = static_cast<Limb>(s >> (8 * sizeof(Limb)));
+        }
+        return carry;
+    }
+
+    template<typename Limb>
+    Limb add_1(Limb *r, Limb const *a, size_t n, Limb x) {
+        size_t i = 0;
+        for (; i < n && x; i++) {
+            Limb s = a[i] + x;
+            x = s < x ? 1 : 0;
+            r[i] = s;
+        }
+        if (r != a) {
+            std::copy(a + i, a + n, r + i);
+        }
+        return x;
+    }
+
+    template<typename Limb>
+    Limb add(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn) {
+        Limb carry = add_n(r, a, b, bn);
+        return add_1(r + bn, a + bn, an - bn, carry);
+    }
+
+    template<typename Limb>
+    Limb sub_n(Limb *r, Limb const *a, Limb const *b, size_t n) {
+        Limb borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            Limb d = a[i] - b[i];
+            Limb next = (a[i] < b[i]) | (d < borrow);
+            r[i] = d - borrow;
+            borrow = next;
+        }
+        return borrow;
+    }
+
+    template<typename Limb>
+    Limb sub_1(Limb *r, Limb const *a, size_t n, Limb x) {
+        size_t i = 0;
+        for (; i < n && x; i++) {
+            Limb d = a[i] - x;
+            x = a[i] < x ? 1 : 0;
+            r[i] = d;
+        }
+        if (r != a) {
+            std::copy(a + i, a + n, r + i);
+        }
+        return x;
+    }
+
+    template<typename Limb>
+    Limb sub(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn) {
+        Limb borrow = sub_n(r, a, b, bn);
+        return sub_1(r + bn, a + bn, an - bn, borrow);
+    }
+
+    template<typename Limb>
+    Limb addmul_1(Limb *r, Limb const *a, size_t n, Limb x) {
+        typedef typename limb_traits<Limb>::wide wide;
+        Limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            wide t = wide(a[i]) * x + r[i] + carry;
+            r[i] = static_cast<Limb>(t);
+            carry = static_cast<Limb>(t >> (8 * sizeof(Limb)));
+        }
+        return carry;
+    }
+
+    template<typename Limb>
+    Limb submul_1(Limb *r, Limb const *a, size_t n, Limb x) {
+        typedef typename limb_traits<Limb>::wide wide;
+        Limb borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            wide t = wide(a[i]) * x + borrow;
+            Limb lo = static_cast<Limb>(t);
+            borrow = static_cast<Limb>(t >> (8 * sizeof(Limb))) + (r[i] < lo);
+            r[i] -= lo;
+        }
+        return borrow;
+    }
+
+    template<typename Limb>
+    Limb lshift(Limb *r, Limb const *a, size_t n, unsigned cnt) {
+        unsigned const bits = 8 * sizeof(Limb);
+        Limb out = a[n - 1] >> (bits - cnt);
+        for (size_t i = n - 1; i > 0; i--) {
+            r[i] = (a[i] << cnt) | (a[i - 1] >> (bits - cnt));
+        }
+        r[0] = a[0] << cnt;
+        return out;
+    }
+
+    template<typename Limb>
+    void rshift(Limb *r, Limb const *a, size_t n, unsigned cnt) {
+        unsigned const bits = 8 * sizeof(Limb);
+        for (size_t i = 0; i + 1 < n; i++) {
+            r[i] = (a[i] >> cnt) | (a[i + 1] << (bits - cnt));
+        }
+        r[n - 1] = a[n - 1] >> cnt;
+    }
+
+    template<typename Limb>
+    int cmp(Limb const *a, size_t an, Limb const *b, size_t bn) {
+        if (an != bn) {
+            return an < bn ? -1 : 1;
+        }
+        for (size_t i = an; i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    template<typename Limb>
+    size_t normalized_size(Limb const *a, size_t n) {
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+
+    // Schoolbook below this many limbs of the shorter operand, Karatsuba above;
+    // the crossover is about the same for both limb widths
+    size_t const karatsuba_threshold = 32;
+
+    template<typename Limb>
+    void mul(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn);
+
+    template<typename Limb>
+    void mul_basecase(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn) {
+        std::fill(r, r + an, 0);
+        for (size_t j = 0; j < bn; j++) {
+            r[an + j] = addmul_1(r + j, a, an, b[j]);
+        }
+    }
+
+    // r[0..an + bn) = a * b, an >= bn > 0, r does not overlap the operands
+    template<typename Limb>
+    void mul_karatsuba(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn) {
+        size_t m = (an + 1) / 2;
+        if (bn <= m) {
+            // split the longer operand into chunks of bn limbs
+            std::fill(r, r + an + bn, 0);
+            std::vector<Limb> tmp(2 * bn);
+            for (size_t i = 0; i < an; i += bn) {
+                size_t len = std::min(bn, an - i);
+                mul(tmp.data(), a + i, len, b, bn);
+                add(r + i, r + i, an + bn - i, tmp.data(), len + bn);
+            }
+            return;
+        }
+        // a = a1 * BASE^m + a0, b = b1 * BASE^m + b0
+        size_t a1n = an - m, b1n = bn - m;
+        mul(r, a, m, b, m);
+        mul(r + 2 * m, a + m, a1n, b + m, b1n);
+
+        // (a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1
+        std::vector<Limb> tmp(4 * m + 4);
+        Limb *sa = tmp.data(), *sb = sa + m + 1, *mid = sb + m + 1;
+        sa[m] = add(sa, a, m, a + m, a1n);
+        sb[m] = add(sb, b, m, b + m, b1n);
+        size_t san = normalized_size(sa, m + 1), sbn = normalized_size(sb, m + 1);
+        std::fill(mid + san + sbn, mid + 2 * m + 2, 0);
+        mul(mid, sa, san, sb, sbn);
+        sub(mid, mid, 2 * m + 2, r, 2 * m);
+        sub(mid, mid, 2 * m + 2, r + 2 * m, a1n + b1n);
+        add(r + m, r + m, an + bn - m, mid, normalized_size(mid, 2 * m + 2));
+    }
+
+    template<typename Limb>
+    void mul(Limb *r, Limb const *a, size_t an, Limb const *b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (bn == 0) {
+            std::fill(r, r + an, 0);
+        } else if (bn < karatsuba_threshold) {
+            mul_basecase(r, a, an, b, bn);
+        } else {
+            mul_karatsuba(r, a, an, b, bn);
+        }
+    }
+
+    // Knuth's algorithm D: q[0..an - dn + 1) = a / d, r[0..dn) = a % d, an >= dn, d[dn - 1] != 0
+    template<typename Limb>
+    void divrem(Limb *q, Limb *r, Limb const *a, size_t an, Limb const *d, size_t dn) {
+        typedef typename limb_traits<Limb>::wide wide;
+        unsigned const bits = 8 * sizeof(Limb);
+        if (dn == 1) {
+            wide rem = 0;
+            for (size_t i = an; i-- > 0;) {
+                wide cur = (rem << bits) | a[i];
+                q[i] = static_cast<Limb>(cur / d[0]);
+                rem = cur % d[0];
+            }
+            r[0] = static_cast<Limb>(rem);
+            return;
+        }
+        unsigned s = limb_traits<Limb>::clz(d[dn - 1]);
+        std::vector<Limb> na(an + 1, 0), nd(d, d + dn);
+        std::copy(a, a + an, na.begin());
+        if (s) {
+            na[an] = lshift(na.data(), na.data(), an, s);
+            lshift(nd.data(), nd.data(), dn, s);
+        }
+        wide const d1 = nd[dn - 1], d0 = nd[dn - 2];
+        for (size_t j = an - dn + 1; j-- > 0;) {
+            // estimate from three leading digits is at most one too large
+            wide num = (wide(na[j + dn]) << bits) | na[j + dn - 1];
+            wide qhat = num / d1, rhat = num % d1;
+            while ((qhat >> bits) || qhat * d0 > ((rhat << bits) | na[j + dn - 2])) {
+                qhat--;
+                rhat += d1;
+                if (rhat >> bits) {
+                    break;
+                }
+            }
+            Limb borrow = submul_1(na.data() + j, nd.data(), dn, static_cast<Limb>(qhat));
+            if (na[j + dn] < borrow) {
+                qhat--;
+                add_n(na.data() + j, na.data() + j, nd.data(), dn);
+            }
+            na[j + dn] = 0;
+            q[j] = static_cast<Limb>(qhat);
+        }
+        if (s) {
+            rshift(r, na.data(), dn, s);
+        } else {
+            std::copy(na.begin(), na.begin() + dn, r);
+        }
+    }
+}
+
+template<typename Limb>
+struct basic_big_integer {
+    basic_big_integer() = default;
+
+    basic_big_integer(long long x) : negative(x < 0) {
+        unsigned long long m = negative ? 0ull - static_cast<unsigned long long>(x) : x;
+        // two half shifts, a shift by the full width of m is undefined
+        for (; m; m >>= 4 * sizeof(Limb), m >>= 4 * sizeof(Limb)) {
+            digits.push_back(static_cast<Limb>(m));
+        }
+    }
+
+    explicit basic_big_integer(big_integer const &x) : negative(x.sign < 0) {
+        size_t n = x.value.size(), per = sizeof(Limb) / sizeof(uint32_t);
+        uint32_t const *d = x.value.data();
+        digits.assign((n + per - 1) / per, 0);
+        for (size_t i = 0; i < n; i++) {
+            digits[i / per] |= Limb(d[i]) << (32 * (i % per));
+        }
+        normalize();
+    }
+
+    explicit operator big_integer() const {
+        size_t per = sizeof(Limb) / sizeof(uint32_t);
+        big_integer res;
+        if (digits.empty()) {
+            return res;
+        }
+        res.value.resize(digits.size() * per);
+        uint32_t *d = res.value.mutable_data();
+        for (size_t i = 0; i < digits.size() * per; i++) {
+            d[i] = static_cast<uint32_t>(digits[i / per] >> (32 * (i % per)));
+        }
+        res.shrink_to_fit();
+        res.sign = negative ? -1 : 1;
+        return res;
+    }
+
+    explicit basic_big_integer(std::string const &str) : basic_big_integer(big_integer(str)) {}
+
+    basic_big_integer operator-() const {
+        basic_big_integer res = *this;
+        res.negative = !negative && !digits.empty();
+        return res;
+    }
+
+    basic_big_integer &operator+=(basic_big_integer const &rhs) {
+        return *this = *this + rhs;
+    }
+
+    basic_big_integer &operator-=(basic_big_integer const &rhs) {
+        return *this = *this - rhs;
+    }
+
+    basic_big_integer &operator*=(basic_big_integer const &rhs) {
+        return *this = *this * rhs;
+    }
+
+    basic_big_integer &operator/=(basic_big_integer const &rhs) {
+        return *this = *this / rhs;
+    }
+
+    basic_big_integer &operator%=(basic_big_integer const &rhs) {
+        return *this = *this % rhs;
+    }
+
+    friend basic_big_integer operator+(basic_big_integer const &a, basic_big_integer const &b) {
+        return signed_sum(a, b, b.negative);
+    }
+
+    friend basic_big_integer operator-(basic_big_integer const &a, basic_big_integer const &b) {
+        return signed_sum(a, b, !b.negative);
+    }
+
+    friend basic_big_integer operator*(basic_big_integer const &a, basic_big_integer const &b) {
+        basic_big_integer res;
+        if (a.digits.empty() || b.digits.empty()) {
+            return res;
+        }
+        res.digits.resize(a.digits.size() + b.digits.size());
+        wide_limbs::mul(res.digits.data(), a.digits.data(), a.digits.size(), b.digits.data(), b.digits.size());
+        res.negative = a.negative != b.negative;
+        res.normalize();
+        return res;
+    }
+
+    friend basic_big_integer operator/(basic_big_integer const &a, basic_big_integer const &b) {
+        return divmod(a, b).first;
+    }
+
+    friend basic_big_integer operator%(basic_big_integer const &a, basic_big_integer const &b) {
+        return divmod(a, b).second;
+    }
+
+    // Quotient and remainder of truncating division
+    friend std::pair<basic_big_integer, basic_big_integer> divmod(basic_big_integer const &a,
+                                                                 basic_big_integer const &b) {
+        if (b.digits.empty()) {
+            throw std::runtime_error("Division by zero");
+        }
+        size_t an = a.digits.size(), bn = b.digits.size();
+        if (an < bn) {
+            return {basic_big_integer(), a};
+        }
+        basic_big_integer q, r;
+        q.digits.resize(an - bn + 1);
+        r.digits.resize(bn);
+        wide_limbs::divrem(q.digits.data(), r.digits.data(), a.digits.data(), an, b.digits.data(), bn);
+        q.negative = a.negative != b.negative;
+        r.negative = a.negative;
+        q.normalize();
+        r.normalize();
+        return {q, r};
+    }
+
+    friend bool operator==(basic_big_integer const &a, basic_big_integer const &b) {
+        return a.negative == b.negative && a.digits == b.digits;
+    }
+
+    friend bool operator!=(basic_big_integer const &a, basic_big_integer const &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(basic_big_integer const &a, basic_big_integer const &b) {
+        if (a.negative != b.negative) {
+            return a.negative;
+        }
+        int c = wide_limbs::cmp(a.digits.data(), a.digits.size(), b.digits.data(), b.digits.size());
+        return a.negative ? c > 0 : c < 0;
+    }
+
+    friend bool operator>(basic_big_integer const &a, basic_big_integer const &b) {
+        return b < a;
+    }
+
+    friend bool operator<=(basic_big_integer const &a, basic_big_integer const &b) {
+        return !(b < a);
+    }
+
+    friend bool operator>=(basic_big_integer const &a, basic_big_integer const &b) {
+        return !(a < b);
+    }
+
+    friend std::string to_string(basic_big_integer const &a) {
+        return to_string(big_integer(a));
+    }
+
+   private:
+    static basic_big_integer signed_sum(basic_big_integer const &a, basic_big_integer const &b, bool b_negative) {
+        basic_big_integer res;
+        auto const &x = a.digits, &y = b.digits;
+        if (a.negative == b_negative) {
+            auto const &g = x.size() >= y.size() ? x : y;
+            auto const &l = x.size() >= y.size() ? y : x;
+            res.digits.resize(g.size() + 1);
+            res.digits[g.size()] = wide_limbs::add(res.digits.data(), g.data(), g.size(), l.data(), l.size());
+            res.negative = a.negative;
+        } else if (wide_limbs::cmp(x.data(), x.size(), y.data(), y.size()) >= 0) {
+            res.digits.resize(x.size());
+            wide_limbs::sub(res.digits.data(), x.data(), x.size(), y.data(), y.size());
+            res.negative = a.negative;
+        } else {
+            res.digits.resize(y.size());
+            wide_limbs::sub(res.digits.data(), y.data(), y.size(), x.data(), x.size());
+            res.negative = b_negative;
+        }
+        res.normalize();
+        return res;
+    }
+
+    void normalize() {
+        digits.resize(wide_limbs::normalized_size(digits.data(), digits.size()));
+        if (digits.empty()) {
+            negative = false;
+        }
+    }
+
+    // Magnitude without leading zeros, empty for 0
+    bool negative = false;
+    std::vector<Limb> digits;
+};
+
+#endif  // BASIC_BIG_INTEGER_H
@@ -1,11 +1,17 @@
 #include "big_integer.h"
+#include "limb_ops.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
-__extension__ typedef unsigned __int128 uint128_t;
+const uint32_t BITS_IN_DIGIT = 32;
 
 big_integer::big_integer() {
     value.push_back(0);
@@ -17,6 +23,12 @@ big_integer::big_integer(big_integer const &other) {
     sign = other.sign;
 }
 
+big_integer::big_integer(big_integer &&other) noexcept : sign(other.sign), value(std::move(other.value)) {
+    // moved-from number is left equal to zero
+    other.value.push_back(0);
+    other.sign = 1;
+}
+
 big_integer::big_integer(int a) {
     if (a == INT32_MIN) {
         value.push_back(2147483648u);
@@ -26,17 +38,10 @@ big_integer::big_integer(int a) {
     sign = (a >= 0) ? 1 : -1;
 }
 
-big_integer::big_integer(std::string const &str) {
-    value.push_back(0);
-    big_integer base = 1;
-    for (int32_t i = static_cast<int32_t>(str.length()) - 1;
-         i >= 0 && str[i] != '-'; i--) {
-        auto addition = static_cast<uint32_t>(str[i] - '0');
-        *this += base * addition;
-        base *= 10;
-    }
-    sign = str[0] == '-' ? -1 : 1;
-    shrink_to_fit();
+big_integer::big_integer(std::string const &str) : big_integer(str, 10) {}
+
+big_integer::big_integer(std::string const &str, unsigned base) {
+    *this = parse(str.data(), str.size(), base);
 }
 
 big_integer::~big_integer() {
@@ -44,57 +49,107 @@ big_integer::~big_integer() {
 }
 
 void big_integer::shrink_to_fit() {
-    while (value.size() > 1 && value[value.size() - 1] == 0) {
-        value.pop_back();
-    }
+    size_t n = limbs::normalized_size(value.data(), value.size());
+    value.resize(n ? n : 1);
 }
 
-big_integer big_integer::get_adding_code() const {
-    if (sign > 0) {
-        return *this;
-    }
-    big_integer res;
-    res.value.pop_back();
-    for (size_t i = 0; i < value.size(); i++) {
-        res.value.push_back(~value[i]);
-    }
-    res.value.push_back(UINT32_MAX);  // all 1 in additional code
-    res += 1;
-    res.sign = is_zero() ? 1 : -1;
-    return res;
+bool big_integer::is_zero() const {
+    return (value.size() == 1 && value[0] == 0);
 }
 
-big_integer big_integer::complement_to_unsigned() const {
-    if (sign > 0) {
-        return *this;
+big_integer &big_integer::operator=(big_integer const &other) {
+    value = other.value;
+    sign = other.sign;
+    return *this;
+}
+
+big_integer &big_integer::operator=(big_integer &&other) noexcept {
+    if (this != &other) {
+        value = std::move(other.value);
+        sign = other.sign;
+        other.value.push_back(0);
+        other.sign = 1;
     }
-    big_integer res;
-    res.value.pop_back();
-    for (size_t i = 0; i < value.size(); i++) {
-        res.value.push_back(~value[i]);
+    return *this;
+}
+
+namespace {
+    __extension__ typedef unsigned __int128 uint128;
+}
+
+bool big_integer::is_small() const {
+    return value.size() <= 2;
+}
+
+uint64_t big_integer::small_magnitude() const {
+    uint64_t res = value[0];
+    if (value.size() == 2) {
+        res |= uint64_t(value[1]) << 32;
     }
-    res += 1;
-    res.shrink_to_fit();
-    res.sign = sign;
     return res;
 }
 
-bool big_integer::is_zero() const {
-    return (value.size() == 1 && value[0] == 0);
+void big_integer::assign_small(uint64_t lo, uint64_t hi, int32_t s) {
+    uint32_t d[4] = {static_cast<uint32_t>(lo), static_cast<uint32_t>(lo >> 32),
+                     static_cast<uint32_t>(hi), static_cast<uint32_t>(hi >> 32)};
+    size_t n = hi ? (hi >> 32 ? 4 : 3) : (lo >> 32 ? 2 : 1);
+    value.resize(n);
+    std::copy(d, d + n, value.mutable_data());
+    sign = (lo | hi) ? s : 1;
 }
 
-big_integer &big_integer::operator=(big_integer const &other) {
-    value = other.value;
-    sign = other.sign;
+void big_integer::small_sum(big_integer &res, big_integer const &a, big_integer const &b, int32_t b_sign) {
+    uint64_t x = a.small_magnitude(), y = b.small_magnitude(), sum;
+    if (a.sign == b_sign) {
+        bool carry = __builtin_add_overflow(x, y, &sum);
+        res.assign_small(sum, carry, b_sign);
+    } else if (x >= y) {
+        res.assign_small(x - y, 0, a.sign);
+    } else {
+        res.assign_small(y - x, 0, b_sign);
+    }
+}
+
+big_integer &big_integer::add_in_place(big_integer const &rhs, int32_t rhs_sign) {
+    if (is_small() && rhs.is_small()) {
+        small_sum(*this, *this, rhs, rhs_sign);
+        return *this;
+    }
+    // rhs may be *this, so its size is taken before any resize
+    size_t n = value.size(), m = rhs.value.size();
+    if (sign == rhs_sign) {
+        size_t len = std::max(n, m);
+        value.resize(len + 1);
+        uint32_t *d = value.mutable_data();
+        std::fill(d + n, d + len + 1, 0);
+        d[len] = limbs::add(d, d, len, rhs.value.data(), m);
+    } else {
+        int c = limbs::cmp(value.data(), n, rhs.value.data(), m);
+        if (c >= 0) {
+            uint32_t *d = value.mutable_data();
+            limbs::sub(d, d, n, rhs.value.data(), m);
+        } else {
+            // |rhs| - |this| written over this, operands start at the same digit
+            value.resize(m);
+            uint32_t *d = value.mutable_data();
+            std::fill(d + n, d + m, 0);
+            limbs::sub(d, rhs.value.data(), m, d, n);
+            sign = rhs_sign;
+        }
+    }
+    shrink_to_fit();
+    if (is_zero()) {
+        sign = 1;
+    }
     return *this;
 }
 
 big_integer &big_integer::operator+=(big_integer const &rhs) {
-    return (*this = *this + rhs);
+    return add_in_place(rhs, rhs.sign);
 }
 
 big_integer &big_integer::operator-=(big_integer const &rhs) {
-    return (*this = *this - rhs);
+    return add_in_place(rhs, -rhs.sign);
 }
 
 big_integer &big_integer::operator*=(big_integer const &rhs) {
@@ -122,11 +177,21 @@ big_integer &big_integer::operator^=(big_integer const &rhs) {
 }
 
 big_integer &big_integer::operator<<=(int rhs) {
-    return (*this = *this << rhs);
+    if (rhs < 0) {
+        shift_right_in_place(size_t(-int64_t(rhs)));
+    } else {
+        shift_left_in_place(size_t(rhs));
+    }
+    return *this;
 }
 
 big_integer &big_integer::operator>>=(int rhs) {
-    return (*this = *this >> rhs);
+    if (rhs < 0) {
+        shift_left_in_place(size_t(-int64_t(rhs)));
+    } else {
+        shift_right_in_place(size_t(rhs));
+    }
+    return *this;
 }
 
 big_integer big_integer::operator+() const { return *this; }
@@ -147,99 +212,175 @@ big_integer big_integer::operator~() const {
     return -(res + 1);
 }
 
-big_integer &big_integer::operator++() { return (*this = *this + 1); }
+void big_integer::increase_magnitude() {
+    uint32_t *d = value.mutable_data();
+    if (limbs::add_1(d, d, value.size(), 1)) {
+        value.push_back(1);
+    }
+}
+
+void big_integer::decrease_magnitude() {
+    // magnitude is not zero
+    uint32_t *d = value.mutable_data();
+    limbs::sub_1(d, d, value.size(), 1);
+    shrink_to_fit();
+    if (is_zero()) {
+        sign = 1;
+    }
+}
+
+big_integer &big_integer::operator++() {
+    if (sign < 0) {
+        decrease_magnitude();
+    } else {
+        increase_magnitude();
+    }
+    return *this;
+}
 
 big_integer big_integer::operator++(int) {
     big_integer res = *this;
-    *this = *this + 1;
+    ++*this;
     return res;
 }
 
-big_integer &big_integer::operator--() { return (*this = *this - 1); }
+big_integer &big_integer::operator--() {
+    if (sign > 0 && !is_zero()) {
+        decrease_magnitude();
+    } else {
+        increase_magnitude();
+        sign = -1;
+    }
+    return *this;
+}
 
 big_integer big_integer::operator--(int) {
     big_integer res = *this;
-    *this = *this - 1;
+    --*this;
     return res;
 }
 
-big_integer operator+(big_integer const &a, big_integer const &b) {
-    if (b.sign < 0) {
-        return a - (-b);
-    } else if (a.sign < 0) {
-        return b - (-a);
-    }
-    big_integer res = a;
-    uint64_t carry = 0;
-    for (size_t i = 0; i < std::max(res.value.size(), b.value.size()) || carry; i++) {
-        if (i == res.value.size()) {
+big_integer big_integer::signed_sum(big_integer const &a, big_integer const &b, int32_t b_sign) {
+    big_integer res;
+    sum_into(res, a, b, b_sign);
+    return res;
+}
+
+void big_integer::sum_into(big_integer &res, big_integer const &a, big_integer const &b, int32_t b_sign) {
+    if (&res == &a) {
+        res.add_in_place(b, b_sign);
+        return;
+    }
+    if (&res == &b) {
+        // a + b_sign * |res|
+        res.sign = b_sign;
+        res.add_in_place(a, a.sign);
+        return;
+    }
+    if (a.is_small() && b.is_small()) {
+        small_sum(res, a, b, b_sign);
+        return;
+    }
+    // a buffer shared with other numbers is let go instead of being copied
+    res.value.clear();
+    size_t n = a.value.size(), m = b.value.size();
+    if (a.sign == b_sign) {
+        auto const &longer = n >= m ? a.value : b.value;
+        auto const &shorter = n >= m ? b.value : a.value;
+        size_t len = std::max(n, m);
+        res.value.resize(len + 1);
+        uint32_t *d = res.value.mutable_data();
+        d[len] = limbs::add(d, longer.data(), len, shorter.data(), std::min(n, m));
+        res.sign = a.sign;
+    } else {
+        int c = limbs::cmp(a.value.data(), n, b.value.data(), m);
+        if (c == 0) {
             res.value.push_back(0);
+            res.sign = 1;
+            return;
+        } else if (c > 0) {
+            res.value.resize(n);
+            limbs::sub(res.value.mutable_data(), a.value.data(), n, b.value.data(), m);
+            res.sign = a.sign;
+        } else {
+            res.value.resize(m);
+            limbs::sub(res.value.mutable_data(), b.value.data(), m, a.value.data(), n);
+            res.sign = b_sign;
         }
-        uint64_t add_res = res.value[i] + carry + (i < b.value.size() ? b.value[i] : 0);
-        carry = (add_res >= (uint64_t(UINT32_MAX) + 1) ? 1 : 0);
-        if (carry) {
-            add_res -= (uint64_t(UINT32_MAX) + 1);
-        }
-        res.value.modify(i, static_cast<uint32_t>(add_res));
     }
-    return res;
+    res.shrink_to_fit();
+}
+
+big_integer operator+(big_integer const &a, big_integer const &b) {
+    return big_integer::signed_sum(a, b, b.sign);
+}
+
+big_integer operator+(big_integer &&a, big_integer const &b) {
+    a += b;
+    return std::move(a);
+}
+
+big_integer operator+(big_integer const &a, big_integer &&b) {
+    b += a;
+    return std::move(b);
+}
+
+big_integer operator+(big_integer &&a, big_integer &&b) {
+    a += b;
+    return std::move(a);
 }
 
 big_integer operator-(big_integer const &a, big_integer const &b) {
-    if (a.sign < 0) {
-        return -((-a) + b);
-    } else if (b.sign < 0) {
-        return a + (-b);
-    }
-    int32_t result_sign = (a > b) ? 1 : -1;
-    auto greater = a, lesser = b;
-    if (result_sign == -1) {
-        std::swap(greater, lesser);
-    }
-    int64_t carry = 0;
-    for (size_t i = 0; i < lesser.value.size() || carry; i++) {
-        int64_t sub_res = greater.value[i] - (carry + (i < lesser.value.size() ? lesser.value[i] : 0));
-        carry = (sub_res < 0) ? 1 : 0;
-        if (carry) {
-            sub_res += (uint64_t(UINT32_MAX) + 1);
-        }
-        greater.value.modify(i, static_cast<uint32_t>(sub_res));
-    }
-    greater.shrink_to_fit();
-    greater.sign = greater.is_zero() ? 1 : result_sign;
-    return greater;
+    return big_integer::signed_sum(a, b, -b.sign);
 }
 
-std::pair<big_integer, uint32_t> big_integer::div_long_short(uint32_t x) const {
-    if (x == 0) {
-        throw std::runtime_error("Division by zero");
-    }
-    uint64_t carry = 0;
-    big_integer res;
-    res.value.pop_back();
-    res.value.resize(value.size());
-    for (int32_t i = static_cast<int32_t>(value.size()) - 1; i >= 0; i--) {
-        uint64_t cur_val = value[i] + carry * (uint64_t(UINT32_MAX) + 1);
-        res.value.modify(size_t(i), static_cast<uint32_t>(cur_val / x));
-        carry = cur_val % x;
-    }
-    res.sign = res.is_zero() ? 1 : sign;
-    res.shrink_to_fit();
-    return {res, carry};
+big_integer operator-(big_integer &&a, big_integer const &b) {
+    a -= b;
+    return std::move(a);
+}
+
+big_integer operator-(big_integer &&a, big_integer &&b) {
+    a -= b;
+    return std::move(a);
 }
 
 big_integer operator*(big_integer const &a, big_integer const &b) {
     big_integer res;
-    res.value.resize(a.value.size() + b.value.size());
-    uint64_t carry = 0;
+    if (a.is_small() && b.is_small()) {
+        uint128 p = uint128(a.small_magnitude()) * b.small_magnitude();
+        res.assign_small(static_cast<uint64_t>(p), static_cast<uint64_t>(p >> 64), a.sign * b.sign);
+        return res;
+    }
+    size_t an = a.value.size(), bn = b.value.size();
+    res.value.resize(an + bn);
+    if (a.value.data() == b.value.data() && an == bn) {
+        // x * x or copies sharing digits
+        limbs::sqr(res.value.mutable_data(), a.value.data(), an);
+    } else {
+        limbs::mul(res.value.mutable_data(), a.value.data(), an, b.value.data(), bn);
+    }
     res.sign = a.sign * b.sign;
-    for (uint32_t i = 0; i < a.value.size(); i++) {
-        for (uint32_t j = 0; j < b.value.size() || carry; j++) {
-            uint128_t mul_res = res.value[i + j] + a.value[i] * 1ull * (j < b.value.size() ? b.value[j] : 0) + carry;
-            res.value.modify(i + j, static_cast<uint32_t>(mul_res % (uint64_t(UINT32_MAX) + 1)));
-            carry = static_cast<uint32_t>(mul_res / (uint64_t(UINT32_MAX) + 1));
-        }
+    res.shrink_to_fit();
+    if (res.is_zero()) {
+        res.sign = 1;
     }
+    return res;
+}
+
+void big_integer::set_multiplication_threads(size_t threads, size_t min_task_digits) {
+    limbs::set_mul_threads(threads);
+    limbs::parallel_mul_threshold = min_task_digits;
+}
+
+big_integer big_integer::mul_ntt(big_integer const &a, big_integer const &b) {
+    size_t an = a.value.size(), bn = b.value.size();
+    if (an + bn > limbs::ntt_max_size) {
+        throw std::length_error("Operands are too long for NTT multiplication");
+    }
+    big_integer res;
+    res.value.resize(an + bn);
+    limbs::mul_ntt(res.value.mutable_data(), a.value.data(), an, b.value.data(), bn);
+    res.sign = a.sign * b.sign;
     res.shrink_to_fit();
     if (res.is_zero()) {
         res.sign = 1;
@@ -247,275 +388,689 @@ big_integer operator*(big_integer const &a, big_integer const &b) {
     return res;
 }
 
-bool big_integer::smaller(big_integer const &dq, uint64_t k, uint64_t m) const {
-    uint64_t i = m, j = 0;
-    while (i != j) {
-        if (value[i + k] != dq.value[i]) {
-            j = i;
-        } else {
-            i--;
-        }
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b) {
+    if (b.is_zero()) {
+        throw std::runtime_error("Division by zero");
+    }
+    size_t an = a.value.size(), bn = b.value.size();
+    if (an < bn) {
+        return {big_integer(), a};
+    }
+    big_integer q, r;
+    if (a.is_small()) {
+        uint64_t x = a.small_magnitude(), y = b.small_magnitude();
+        q.assign_small(x / y, 0, a.sign * b.sign);
+        r.assign_small(x % y, 0, a.sign);
+        return {q, r};
     }
-    return value[i + k] < dq.value[i];
+    q.value.resize(an - bn + 1);
+    r.value.resize(bn);
+    limbs::divrem(q.value.mutable_data(), r.value.mutable_data(), a.value.data(), an, b.value.data(), bn);
+    q.shrink_to_fit();
+    r.shrink_to_fit();
+    q.sign = q.is_zero() ? 1 : a.sign * b.sign;
+    r.sign = r.is_zero() ? 1 : a.sign;
+    return {q, r};
 }
 
-uint32_t big_integer::trial(uint64_t k, uint64_t m, uint64_t const d2) const {
-    const uint128_t BASE = uint128_t(UINT32_MAX) + 1;
-    uint64_t km = k + m;
-    uint128_t r3 = (uint128_t(value[km]) * BASE + uint128_t(value[km - 1])) * BASE + uint128_t(value[km - 2]);
-    return uint32_t(std::min(r3 / uint128_t(d2), uint128_t(UINT32_MAX)));
+big_integer operator/(big_integer const &a, big_integer const &b) {
+    return divmod(a, b).first;
 }
 
-void big_integer::difference(big_integer const &dq, uint64_t k, uint64_t m) {
-    int64_t borrow = 0, diff;
-    const int64_t BASE = int64_t(UINT32_MAX) + 1;
-    for (uint64_t i = 0; i < m + 1; i++) {
-        diff = int64_t(value[i + k]) - int64_t(dq.value[i]) - borrow + BASE;
-        value.modify(i + k, uint32_t(diff % BASE));
-        borrow = 1 - diff / BASE;
+big_integer operator%(big_integer const &a, big_integer const &b) {
+    return divmod(a, b).second;
+}
+
+size_t big_integer::bit_length() const {
+    size_t n = value.size();
+    uint32_t top = value[n - 1];
+    return top ? BITS_IN_DIGIT * n - static_cast<size_t>(__builtin_clz(top)) : 0;
+}
+
+big_integer big_integer::pow(unsigned exponent) const {
+    if (exponent == 0) {
+        return 1;
+    }
+    if (exponent == 1 || is_zero()) {
+        return *this;
+    }
+    if (value.size() == 1 && value[0] == 1) {
+        return exponent % 2 ? *this : big_integer(1);
+    }
+    // |this|^exponent has at most exponent * bit_length() bits, products may have two more digits
+    size_t cap = size_t(exponent) * bit_length() / BITS_IN_DIGIT + 3;
+    big_integer res, tmp;
+    res.value.resize(cap);
+    tmp.value.resize(cap);
+    uint32_t *r = res.value.mutable_data(), *t = tmp.value.mutable_data();
+    uint32_t const *a = value.data();
+    size_t an = value.size(), rn = an;
+    std::copy(a, a + an, r);
+    for (int bit = 30 - __builtin_clz(exponent); bit >= 0; bit--) {
+        limbs::sqr(t, r, rn);
+        rn = limbs::normalized_size(t, 2 * rn);
+        std::swap(r, t);
+        if ((exponent >> bit) & 1) {
+            limbs::mul(t, r, rn, a, an);
+            rn = limbs::normalized_size(t, rn + an);
+            std::swap(r, t);
+        }
+    }
+    if (r != res.value.data()) {
+        res = std::move(tmp);
     }
+    // the bound may be far above the length, the unused digits are given back
+    res.value.resize(rn);
+    res.value.shrink_to_fit();
+    res.sign = sign < 0 && exponent % 2 ? -1 : 1;
+    return res;
 }
 
-big_integer operator/(big_integer const &a, big_integer const &b) {
-    if (b.is_zero()) {
-        throw std::runtime_error("Division by zero");
-    } else if (a.value.size() < b.value.size()) {
+namespace {
+    // whether r^k > v, without overflow
+    bool power_exceeds(uint64_t r, unsigned k, uint64_t v) {
+        uint64_t p = 1;
+        for (unsigned i = 0; i < k; i++) {
+            if (r && p > v / r) {
+                return true;
+            }
+            p *= r;
+        }
+        return p > v;
+    }
+}
+
+big_integer big_integer::iroot_magnitude(big_integer const &a, unsigned k) {
+    size_t bits = a.bit_length();
+    if (k >= bits) {
+        // a < 2^bits <= 2^k, no power is built for huge k
+        return a.is_zero() ? 0 : 1;
+    }
+    if (bits <= 64) {
+        uint64_t v = a.value[0] | (a.value.size() > 1 ? uint64_t(a.value[1]) << 32 : 0);
+        auto r = static_cast<uint64_t>(std::pow(static_cast<long double>(v), 1.0L / k));
+        while (power_exceeds(r, k, v)) {
+            r--;
+        }
+        while (!power_exceeds(r + 1, k, v)) {
+            r++;
+        }
+        // k > 1, so the root fits into one digit
         big_integer res;
+        res.value.modify(0, static_cast<uint32_t>(r));
         return res;
-    } else if (b.value.size() == 1) {
-        return b.sign > 0 ? a.div_long_short(b.value[0]).first : -(a.div_long_short(b.value[0]).first);
-    }
-    int32_t res_sign = a.sign * b.sign;
-    auto n = a.value.size(), m = b.value.size();
-    auto f = (1L << 32) / (uint64_t(b.value[m - 1]) + 1);
-    big_integer r = a * f;
-    big_integer d = b * f;
-    r.sign = 1;
-    d.sign = 1;
-    big_integer q;
-    q.value.resize(n - m + 1);
-    r.value.push_back(0);
-    const uint64_t d2 = (uint64_t(d.value[m - 1]) << 32) + uint64_t(d.value[m - 2]);
-    for (auto k = int32_t(n - m); k >= 0; k--) {
-        // precondition: t has k + m + 1 digits
-        auto qt = r.trial(uint64_t(k), m, d2);
-        big_integer qt_mul;
-        qt_mul.value.modify(0, qt);
-        big_integer dq = qt_mul * d;
-        dq.value.resize(m + 1);
-        if (r.smaller(dq, uint64_t(k), m)) {
-            qt--;
-            dq = d * qt;
+    }
+    // the root has about bits / k bits, the upper half of them comes from a >> (k * s)
+    size_t s = bits / (2 * k);
+    big_integer x;
+    if (s == 0) {
+        // k > bits / 2, so the root is below 4
+        x = 1;
+        while ((x + 1).pow(k) <= a) {
+            x++;
         }
-        q.value.modify(size_t(k), qt);
-        r.difference(dq, uint64_t(k), m);
+        return x;
+    }
+    x = (iroot_magnitude(shift_right(a, k * s), k) + 1) << static_cast<int>(s);
+    // from above Newton's step x' = ((k - 1) x + a / x^(k - 1)) / k decreases down to the root
+    for (;;) {
+        big_integer y = (x * (k - 1) + a / x.pow(k - 1)) / k;
+        if (y >= x) {
+            return x;
+        }
+        x = std::move(y);
     }
-    q.sign = res_sign;
-    q.shrink_to_fit();
-    return q;
 }
 
-big_integer operator%(big_integer const &a, big_integer const &b) {
-    return a - (a / b) * b;
+big_integer big_integer::iroot(unsigned k) const {
+    if (k == 0) {
+        throw std::runtime_error("Zeroth root is undefined");
+    }
+    if (sign < 0 && !is_zero()) {
+        if (k % 2 == 0) {
+            throw std::runtime_error("Even root of a negative number");
+        }
+        return -iroot_magnitude(-*this, k);
+    }
+    if (k == 1 || is_zero()) {
+        return *this;
+    }
+    return iroot_magnitude(*this, k);
 }
 
-big_integer big_integer::logical_op(big_integer const &a, big_integer const &b, uint32_t (*op)(uint32_t, uint32_t),
-                                    int32_t (*sign)(int32_t, int32_t)) const {
-    big_integer greater = a.get_adding_code();
-    big_integer lesser = b.get_adding_code();
-    if (greater.value.size() < lesser.value.size()) {
-        std::swap(greater, lesser);
+big_integer big_integer::isqrt() const {
+    return iroot(2);
+}
+
+template<typename Op>
+big_integer big_integer::logical_op(big_integer const &a, big_integer const &b, Op op) {
+    // Negative numbers are read as ~x + 1 and a negative result is written back the same way.
+    // Each +1 carries only through low zero digits, after them every digit is a plain
+    // op(x ^ mask_a, y ^ mask_b) ^ mask_r.
+    size_t an = a.value.size(), bn = b.value.size(), n = std::max(an, bn);
+    uint32_t const *x = a.value.data(), *y = b.value.data();
+    uint32_t mask_a = a.sign < 0 ? UINT32_MAX : 0, mask_b = b.sign < 0 ? UINT32_MAX : 0;
+    uint32_t mask_r = op(mask_a, mask_b);
+    uint32_t carry_a = mask_a & 1, carry_b = mask_b & 1, carry_r = mask_r & 1;
+    big_integer res;
+    res.value.resize(n + 1);
+    uint32_t *r = res.value.mutable_data();
+    size_t i = 0;
+    for (; i < n && (carry_a | carry_b | carry_r); i++) {
+        uint32_t da = ((i < an ? x[i] : 0) ^ mask_a) + carry_a;
+        uint32_t db = ((i < bn ? y[i] : 0) ^ mask_b) + carry_b;
+        uint32_t dr = (op(da, db) ^ mask_r) + carry_r;
+        carry_a &= da == 0;
+        carry_b &= db == 0;
+        carry_r &= dr == 0;
+        r[i] = dr;
     }
-    for (size_t i = 0; i < lesser.value.size(); i++) {
-        greater.value.modify(i, (*op)(greater.value[i], lesser.value[i]));
+    size_t common = std::min(an, bn);
+    if (i < common) {
+        Op::apply_n(r + i, x + i, y + i, common - i, mask_a, mask_b, mask_r);
+        i = common;
     }
-    for (size_t i = lesser.value.size(); i < greater.value.size(); i++) {
-        greater.value.modify(i, (*op)(greater.value[i], (lesser.sign < 0 ? UINT32_MAX : 0)));
+    for (; i < an; i++) {
+        r[i] = op(x[i] ^ mask_a, mask_b) ^ mask_r;
     }
-    greater.sign = (*sign)(a.sign, b.sign);
-    greater.shrink_to_fit();
-    return greater.complement_to_unsigned();
+    for (; i < bn; i++) {
+        r[i] = op(mask_a, y[i] ^ mask_b) ^ mask_r;
+    }
+    // digits above n are sign copies, so only a carry is left there
+    r[n] = carry_r;
+    res.shrink_to_fit();
+    res.sign = mask_r && !res.is_zero() ? -1 : 1;
+    return res;
+}
+
+namespace {
+    struct and_op {
+        uint32_t operator()(uint32_t x, uint32_t y) const { return x & y; }
+
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                            uint32_t ma, uint32_t mb, uint32_t mr) {
+            limbs::and_n(r, a, b, n, ma, mb, mr);
+        }
+    };
+
+    struct or_op {
+        uint32_t operator()(uint32_t x, uint32_t y) const { return x | y; }
+
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                            uint32_t ma, uint32_t mb, uint32_t mr) {
+            limbs::or_n(r, a, b, n, ma, mb, mr);
+        }
+    };
+
+    struct xor_op {
+        uint32_t operator()(uint32_t x, uint32_t y) const { return x ^ y; }
+
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                            uint32_t ma, uint32_t mb, uint32_t mr) {
+            limbs::xor_n(r, a, b, n, ma, mb, mr);
+        }
+    };
 }
 
 big_integer operator&(big_integer const &a, big_integer const &b) {
-    return a.logical_op(a, b, [](uint32_t x, uint32_t y) { return x & y; },
-            [](int32_t x, int32_t y) { return (x < 0 && y < 0) ? -1 : 1; });
+    return big_integer::logical_op(a, b, and_op());
 }
 
 big_integer operator|(big_integer const &a, big_integer const &b) {
-    return a.logical_op(a, b, [](uint32_t x, uint32_t y) { return x | y; },
-            [](int32_t x, int32_t y) { return (x < 0 || y < 0) ? -1 : 1; });
+    return big_integer::logical_op(a, b, or_op());
 }
 
 big_integer operator^(big_integer const &a, big_integer const &b) {
-    return a.logical_op(a, b, [](uint32_t x, uint32_t y) { return x ^ y; },
-                        [](int32_t x, int32_t y) { return (x < 0 && y > 0) || (x > 0 && y < 0) ? -1 : 1; });
+    return big_integer::logical_op(a, b, xor_op());
 }
 
-const uint32_t BITS_IN_DIGIT = 32;
+namespace {
+    // r[0..n + ds] = a[0..n) << (32 * ds + bits); r may start at a
+    void shift_up(uint32_t *r, uint32_t const *a, size_t n, size_t ds, unsigned bits) {
+        if (bits) {
+            r[n + ds] = limbs::lshift(r + ds, a, n, bits);
+        } else {
+            r[n + ds] = 0;
+            if (r + ds != a) {
+                std::copy_backward(a, a + n, r + n + ds);
+            }
+        }
+        std::fill(r, r + ds, 0);
+    }
 
-big_integer operator<<(big_integer const &a, int b) {
-    if (b < 0) {
-        return a >> abs(b);
-    } else if (b == 0) {
-        return big_integer(a);
-    }
-    auto digit_shift = static_cast<uint32_t>(b);
-    auto bitshift = digit_shift % BITS_IN_DIGIT;
-    digit_shift /= BITS_IN_DIGIT;
+    // r[0..n - ds) = a[0..n) >> (32 * ds + bits), ds < n; r may start at a.
+    // Returns whether any of the dropped bits is set.
+    bool shift_down(uint32_t *r, uint32_t const *a, size_t n, size_t ds, unsigned bits) {
+        bool dropped = std::any_of(a, a + ds, [](uint32_t x) { return x != 0; }) ||
+                       (bits && (a[ds] << (BITS_IN_DIGIT - bits)));
+        if (bits) {
+            limbs::rshift(r, a + ds, n - ds, bits);
+        } else if (r != a + ds) {
+            std::copy(a + ds, a + n, r);
+        }
+        return dropped;
+    }
+}
+
+big_integer big_integer::shift_left(big_integer const &a, size_t cnt) {
+    if (a.is_zero()) {
+        return a;
+    }
+    size_t n = a.value.size(), ds = cnt / BITS_IN_DIGIT;
     big_integer res;
-    res.value.pop_back();
-    for (uint32_t i = 0; i < digit_shift; i++) {
-        res.value.push_back(0);
-    }
-    for (size_t i = 0; i < a.value.size(); i++){
-        res.value.push_back(a.value[i]);
-    }
-    /*
-    for (auto i : a.value) {
-        res.value.push_back(i);
-    }
-    */
-    uint32_t remainder = 0;
-    for (size_t i = digit_shift; i < res.value.size(); i++) {
-        uint32_t tmp = (res.value[i] << bitshift);
-        tmp += remainder;
-        remainder = (res.value[i] >> (BITS_IN_DIGIT - bitshift));
-        res.value.modify(i, tmp);
-    }
-    res.value.push_back(remainder);
+    res.value.resize(n + ds + 1);
+    shift_up(res.value.mutable_data(), a.value.data(), n, ds, cnt % BITS_IN_DIGIT);
     res.shrink_to_fit();
-    res.sign = res.is_zero() ? 1 : a.sign;
+    res.sign = a.sign;
     return res;
 }
 
-big_integer operator>>(big_integer const &a, int b) {
-    if (b < 0) {
-        return a << abs(b);
-    } else if (b == 0) {
-        return big_integer(a);
-    }
-    big_integer num = a;
-    auto digit_shift = static_cast<uint32_t>(b);
-    auto bitshift = digit_shift % BITS_IN_DIGIT;
-    digit_shift /= BITS_IN_DIGIT;
-    if (num.sign < 0) {
-        num = num.get_adding_code();
-        // adding leading infinite 111... sequence for negative number to emulate two's complement.
-        // first 111... uint32_t already got in get_adding_code();
-        for (int32_t i = 0; i < int32_t(digit_shift) - 1; i++) {
-            num.value.push_back(UINT32_MAX);
-        }
+big_integer big_integer::shift_right(big_integer const &a, size_t cnt) {
+    size_t n = a.value.size(), ds = cnt / BITS_IN_DIGIT;
+    if (ds >= n) {
+        return a.sign < 0 ? big_integer(-1) : big_integer();
     }
     big_integer res;
-    if (digit_shift >= num.value.size()) {
-        return res;
+    res.value.resize(n - ds + 1);
+    uint32_t *r = res.value.mutable_data();
+    bool dropped = shift_down(r, a.value.data(), n, ds, cnt % BITS_IN_DIGIT);
+    // negative numbers are rounded toward minus infinity, as in two's complement
+    r[n - ds] = a.sign < 0 && dropped ? limbs::add_1(r, r, n - ds, 1) : 0;
+    res.shrink_to_fit();
+    res.sign = res.is_zero() ? 1 : a.sign;
+    return res;
+}
+
+void big_integer::shift_left_in_place(size_t cnt) {
+    if (is_zero()) {
+        return;
     }
-    res.value.pop_back();
-    for (uint32_t i = digit_shift; i < num.value.size(); i++) {
-        res.value.push_back(num.value[i]);
+    size_t n = value.size(), ds = cnt / BITS_IN_DIGIT;
+    value.resize(n + ds + 1);
+    uint32_t *d = value.mutable_data();
+    shift_up(d, d, n, ds, cnt % BITS_IN_DIGIT);
+    shrink_to_fit();
+}
+
+void big_integer::shift_right_in_place(size_t cnt) {
+    size_t n = value.size(), ds = cnt / BITS_IN_DIGIT;
+    if (ds >= n) {
+        *this = sign < 0 ? big_integer(-1) : big_integer();
+        return;
     }
-    for (uint32_t i = 0; i < res.value.size() - 1; i++) {
-        res.value.modify(i, res.value[i] >> bitshift);
-        // getting last bits
-        uint32_t moving_part = res.value[i + 1] << (BITS_IN_DIGIT - bitshift);
-        res.value.modify(i, res.value[i] + moving_part);
+    // the rounding carry goes above the n - ds shifted digits, past the end only when ds == 0
+    if (ds == 0) {
+        value.resize(n + 1);
     }
-    // res.value[res.value.size() - 1] >>= bitshift;
-    res.value.modify(res.value.size() - 1, res.value[res.value.size() - 1] >> bitshift);
-    res.shrink_to_fit();
-    res.sign = num.sign;
-    if (res.sign < 0) {
-        res.value.pop_back();  // remove leading infinite 111... sequence for negative number.
+    uint32_t *d = value.mutable_data();
+    bool dropped = shift_down(d, d, n, ds, cnt % BITS_IN_DIGIT);
+    d[n - ds] = sign < 0 && dropped ? limbs::add_1(d, d, n - ds, 1) : 0;
+    value.resize(n - ds + 1);
+    shrink_to_fit();
+    if (is_zero()) {
+        sign = 1;
     }
-    res = res.complement_to_unsigned();
-    res.sign = res.is_zero() ? 1 : res.sign;
-    return res;
 }
 
-bool operator==(big_integer const &a, big_integer const &b) {
-    if (a.is_zero() && b.is_zero()) {
-        return true;
+big_integer operator<<(big_integer const &a, int b) {
+    return b < 0 ? big_integer::shift_right(a, size_t(-int64_t(b))) : big_integer::shift_left(a, size_t(b));
+}
+
+big_integer operator>>(big_integer const &a, int b) {
+    return b < 0 ? big_integer::shift_left(a, size_t(-int64_t(b))) : big_integer::shift_right(a, size_t(b));
+}
+
+int compare(big_integer const &a, big_integer const &b) {
+    // zero may carry either sign, so it is ordered by value rather than by sign
+    int sa = a.is_zero() ? 0 : a.sign, sb = b.is_zero() ? 0 : b.sign;
+    if (sa != sb) {
+        return sa < sb ? -1 : 1;
     }
-    if (a.value.size() != b.value.size() || a.sign != b.sign) {
-        return false;
+    int res = limbs::cmp(a.value.data(), a.value.size(), b.value.data(), b.value.size());
+    return sa < 0 ? -res : res;
+}
+
+bool operator==(big_integer const &a, big_integer const &b) { return compare(a, b) == 0; }
+
+bool operator!=(big_integer const &a, big_integer const &b) { return compare(a, b) != 0; }
+
+bool operator<(big_integer const &a, big_integer const &b) { return compare(a, b) < 0; }
+
+bool operator>(big_integer const &a, big_integer const &b) { return compare(a, b) > 0; }
+
+bool operator<=(big_integer const &a, big_integer const &b) { return compare(a, b) <= 0; }
+
+bool operator>=(big_integer const &a, big_integer const &b) { return compare(a, b) >= 0; }
+
+namespace {
+    // Decimal conversion works with 10^9, the largest power of ten in a digit
+    const uint32_t DECIMAL_BASE = 1000000000;
+    const size_t DECIMAL_BASE_DIGITS = 9;
+    // Shorter numbers (in digits of 2^32) are converted by the quadratic loop over 10^9
+    const size_t RADIX_DC_THRESHOLD = 40;
+
+    char const DIGIT_CHARS[] = "0123456789abcdefghijklmnopqrstuv";
+
+    struct digit_table {
+        uint8_t value[256];
+
+        digit_table() {
+            std::fill(value, value + 256, 32);
+            for (unsigned i = 0; i < 32; i++) {
+                value[static_cast<unsigned char>(DIGIT_CHARS[i])] = static_cast<uint8_t>(i);
+                value[static_cast<unsigned char>(std::toupper(DIGIT_CHARS[i]))] = static_cast<uint8_t>(i);
+            }
+        }
+    };
+
+    // value of a digit character of any base up to 32, 32 for anything else
+    unsigned digit_value(char c) {
+        // function-local, numbers may be parsed by static initializers of other files
+        static digit_table const table;
+        return table.value[static_cast<unsigned char>(c)];
     }
-    for (uint32_t i = 0; i < a.value.size(); i++) {
-        if (a.value[i] != b.value[i]) {
-            return false;
+
+    // bits per digit of a power of two base, 0 for base 10
+    unsigned radix_bits(unsigned base) {
+        switch (base) {
+            case 2:
+                return 1;
+            case 8:
+                return 3;
+            case 10:
+                return 0;
+            case 16:
+                return 4;
+            case 32:
+                return 5;
+            default:
+                throw std::runtime_error("Unsupported base");
         }
     }
-    return true;
 }
 
-bool operator!=(big_integer const &a, big_integer const &b) {
-    return !(a == b);
+big_integer const &big_integer::decimal_power(size_t k) {
+    // powers[k] = 10^(9 * 2^k), deque keeps references valid while it grows
+    thread_local std::deque<big_integer> powers;
+    if (powers.empty()) {
+        powers.emplace_back(static_cast<int>(DECIMAL_BASE));
+    }
+    while (powers.size() <= k) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers[k];
 }
 
-bool operator<(big_integer const &a, big_integer const &b) {
-    if (a.sign != b.sign) {
-        return a.sign < b.sign;
-    } else if (a.value.size() < b.value.size()) {
-        return a.sign == 1;
-    } else if (a.value.size() > b.value.size()) {
-        return a.sign == -1;
-    } else if (a.sign == -1) {
-        return (-a) > (-b);
+big_integer big_integer::from_decimal(char const *str, size_t len) {
+    if (len > RADIX_DC_THRESHOLD * DECIMAL_BASE_DIGITS) {
+        // str = high * 10^(9 * 2^k) + low, where low has at least half of the digits
+        size_t k = 0;
+        while ((DECIMAL_BASE_DIGITS << (k + 1)) < len) {
+            k++;
+        }
+        size_t low_len = DECIMAL_BASE_DIGITS << k;
+        big_integer res = from_decimal(str, len - low_len) * decimal_power(k);
+        res += from_decimal(str + len - low_len, low_len);
+        return res;
     }
-    for (int32_t i = static_cast<int32_t>(a.value.size()) - 1; i >= 0; i--) {
-        if (a.value[i] < b.value[i]) {
-            return true;
-        } else if (a.value[i] > b.value[i]) {
-            return false;
+    big_integer res;
+    res.value.resize(len / DECIMAL_BASE_DIGITS + 1);
+    uint32_t *d = res.value.mutable_data();
+    d[0] = 0;
+    size_t n = 0;
+    // the first chunk takes the remainder, so that the others have exactly nine digits
+    size_t chunk = len % DECIMAL_BASE_DIGITS ? len % DECIMAL_BASE_DIGITS : DECIMAL_BASE_DIGITS;
+    for (size_t pos = 0; pos < len; pos += chunk, chunk = DECIMAL_BASE_DIGITS) {
+        uint32_t x = 0;
+        for (size_t i = 0; i < chunk; i++) {
+            x = x * 10 + static_cast<uint32_t>(str[pos + i] - '0');
+        }
+        uint32_t top = limbs::mul_1(d, d, n, DECIMAL_BASE);
+        top += limbs::add_1(d, d, n, x);
+        if (top) {
+            d[n++] = top;
         }
     }
-    return false;
+    res.value.resize(n ? n : 1);
+    return res;
 }
 
-bool operator>(big_integer const &a, big_integer const &b) {
-    if (a.sign != b.sign) {
-        return a.sign > b.sign;
-    } else if (a.value.size() < b.value.size()) {
-        return a.sign == -1;
-    } else if (a.value.size() > b.value.size()) {
-        return a.sign == 1;
-    } else if (a.sign == -1) {
-        return (-a) < (-b);
+void big_integer::to_decimal(std::string &out, size_t digits) const {
+    size_t n = value.size();
+    if (n > RADIX_DC_THRESHOLD) {
+        // split by the power of ten with about half of the digits
+        size_t k = 0;
+        while (decimal_power(k + 1).value.size() <= (n + 1) / 2) {
+            k++;
+        }
+        big_integer const &p = decimal_power(k);
+        auto qr = divmod(*this, p);
+        size_t low_digits = DECIMAL_BASE_DIGITS << k;
+        qr.first.to_decimal(out, digits ? digits - low_digits : 0);
+        qr.second.to_decimal(out, low_digits);
+        return;
+    }
+    std::vector<uint32_t> q(value.data(), value.data() + n), chunks;
+    while (n > 0) {
+        chunks.push_back(limbs::divrem_1(q.data(), q.data(), n, DECIMAL_BASE));
+        n = limbs::normalized_size(q.data(), n);
     }
-    for (int32_t i = static_cast<int32_t>(a.value.size()) - 1; i >= 0; i--) {
-        if (a.value[i] > b.value[i]) {
-            return true;
-        } else if (a.value[i] < b.value[i]) {
-            return false;
+    std::string res(chunks.size() * DECIMAL_BASE_DIGITS, '0');
+    for (size_t i = 0; i < chunks.size(); i++) {
+        uint32_t x = chunks[i];
+        for (size_t j = 0; j < DECIMAL_BASE_DIGITS; j++, x /= 10) {
+            res[res.size() - i * DECIMAL_BASE_DIGITS - j - 1] = static_cast<char>('0' + x % 10);
         }
     }
-    return false;
+    size_t len = digits;
+    if (!digits) {
+        len = res.size() - std::min(res.find_first_not_of('0'), res.size());
+    }
+    if (len > res.size()) {
+        out.append(len - res.size(), '0');
+        out += res;
+    } else {
+        out.append(res, res.size() - len, len);
+    }
+}
+
+big_integer big_integer::parse(char const *str, size_t len, unsigned base) {
+    unsigned bits = radix_bits(base);
+    size_t start = (len && (str[0] == '-' || str[0] == '+')) ? 1 : 0;
+    if (start == len || !std::all_of(str + start, str + len, [base](char c) { return digit_value(c) < base; })) {
+        throw std::runtime_error("Invalid number format");
+    }
+    big_integer res = bits ? from_power_of_two(str + start, len - start, bits) : from_decimal(str + start, len - start);
+    res.sign = (str[0] == '-' && !res.is_zero()) ? -1 : 1;
+    return res;
 }
 
-bool operator<=(big_integer const &a, big_integer const &b) { return !(a > b); }
+big_integer big_integer::from_power_of_two(char const *str, size_t len, unsigned bits) {
+    // the last character holds the lowest bits, each one lands in at most two digits
+    big_integer res;
+    size_t n = (len * bits + BITS_IN_DIGIT - 1) / BITS_IN_DIGIT;
+    res.value.resize(n);
+    uint32_t *d = res.value.mutable_data();
+    std::fill(d, d + n, 0);
+    for (size_t i = 0; i < len; i++) {
+        uint32_t x = digit_value(str[len - 1 - i]);
+        size_t pos = i * bits, k = pos / BITS_IN_DIGIT, off = pos % BITS_IN_DIGIT;
+        d[k] |= x << off;
+        if (off + bits > BITS_IN_DIGIT) {
+            d[k + 1] |= x >> (BITS_IN_DIGIT - off);
+        }
+    }
+    res.shrink_to_fit();
+    return res;
+}
 
-bool operator>=(big_integer const &a, big_integer const &b) { return !(a < b); }
+void big_integer::to_power_of_two(std::string &out, unsigned bits) const {
+    uint32_t const *d = value.data();
+    size_t chars = std::max<size_t>((bit_length() + bits - 1) / bits, 1);
+    size_t n = value.size(), start = out.size();
+    out.resize(start + chars);
+    for (size_t i = 0; i < chars; i++) {
+        size_t pos = i * bits, k = pos / BITS_IN_DIGIT, off = pos % BITS_IN_DIGIT;
+        uint32_t x = d[k] >> off;
+        if (off + bits > BITS_IN_DIGIT && k + 1 < n) {
+            x |= d[k + 1] << (BITS_IN_DIGIT - off);
+        }
+        out[start + chars - 1 - i] = DIGIT_CHARS[x & ((1u << bits) - 1)];
+    }
+}
 
-std::string to_string(big_integer const &a) {
+std::string to_string(big_integer const &a, unsigned base) {
+    unsigned bits = radix_bits(base);
+    if (!bits) {
+        return to_string(a);
+    }
     std::string res;
-    big_integer cur = a;
-    bool is_negative = cur.sign == -1;
-    if (cur.is_zero()) {
-        return "0";
+    if (a.sign < 0 && !a.is_zero()) {
+        res.push_back('-');
     }
-    while (!cur.is_zero()) {
-        auto div_res = cur.div_long_short(10);
-        cur = div_res.first;
-        res.push_back('0' + char(div_res.second));
+    a.to_power_of_two(res, bits);
+    return res;
+}
+
+std::string to_string(big_integer const &a) {
+    if (a.is_zero()) {
+        return "0";
     }
-    if (is_negative) {
+    std::string res;
+    if (a.sign < 0) {
         res.push_back('-');
     }
-    std::reverse(res.begin(), res.end());
+    big_integer magnitude = a;
+    magnitude.sign = 1;
+    magnitude.to_decimal(res, 0);
+    return res;
+}
+
+namespace {
+    // bytes[0..n) = little-endian bytes of d, zeros past its end
+    void store_bytes(uint8_t *bytes, size_t n, uint32_t const *d, size_t dn) {
+        size_t copied = std::min(n, 4 * dn);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(bytes, d, copied);
+#else
+        for (size_t i = 0; i < copied; i++) {
+            bytes[i] = static_cast<uint8_t>(d[i / 4] >> (8 * (i % 4)));
+        }
+#endif
+        std::fill(bytes + copied, bytes + n, 0);
+    }
+
+    // d[0..(n + 3) / 4) from little-endian bytes[0..n), or big-endian ones if reversed;
+    // the missing high bytes of the top digit are fill
+    void load_bytes(uint32_t *d, uint8_t const *bytes, size_t n, bool reversed, uint8_t fill) {
+        size_t dn = (n + 3) / 4;
+        d[dn - 1] = fill * 0x01010101u;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (!reversed) {
+            memcpy(d, bytes, n);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < dn; i++) {
+            uint32_t x = 0;
+            for (size_t j = 4; j-- > 0;) {
+                size_t k = 4 * i + j;
+                x = x << 8 | (k < n ? bytes[reversed ? n - 1 - k : k] : fill);
+            }
+            d[i] = x;
+        }
+    }
+}
+
+std::vector<uint8_t> big_integer::export_bytes(byte_order order, sign_encoding encoding) const {
+    uint32_t const *d = value.data();
+    // zero is a single zero digit, it has no bits
+    size_t n = limbs::normalized_size(d, value.size());
+    bool complement = sign < 0 && encoding == sign_encoding::twos_complement;
+    std::vector<uint32_t> lowered;
+    if (complement) {
+        // the bytes of -x are the complemented bytes of x - 1
+        lowered.assign(d, d + n);
+        limbs::sub_1(lowered.data(), lowered.data(), n, 1);
+        n = limbs::normalized_size(lowered.data(), n);
+        d = lowered.data();
+    }
+    size_t bits = n ? 32 * n - static_cast<size_t>(__builtin_clz(d[n - 1])) : 0;
+    std::vector<uint8_t> res(bits / 8 + 1);
+    store_bytes(res.data(), res.size(), d, n);
+    if (complement) {
+        for (auto &b : res) {
+            b = static_cast<uint8_t>(~b);
+        }
+    } else if (sign < 0) {
+        res.back() |= 0x80;
+    }
+    if (order == byte_order::big_endian) {
+        std::reverse(res.begin(), res.end());
+    }
+    return res;
+}
+
+big_integer big_integer::import_bytes(uint8_t const *bytes, size_t n, byte_order order, sign_encoding encoding) {
+    big_integer res;
+    if (n == 0) {
+        return res;
+    }
+    bool reversed = order == byte_order::big_endian;
+    bool negative = (reversed ? bytes[0] : bytes[n - 1]) & 0x80;
+    bool complement = negative && encoding == sign_encoding::twos_complement;
+    size_t dn = (n + 3) / 4;
+    res.value.resize(dn);
+    uint32_t *d = res.value.mutable_data();
+    load_bytes(d, bytes, n, reversed, complement ? 0xff : 0);
+    if (complement) {
+        // x = -(~x + 1) for the sign-extended bytes
+        for (size_t i = 0; i < dn; i++) {
+            d[i] = ~d[i];
+        }
+        res.value.push_back(limbs::add_1(d, d, dn, 1));
+    } else if (negative) {
+        size_t top = n - 1;
+        d[top / 4] &= ~(0x80u << (8 * (top % 4)));
+    }
+    res.shrink_to_fit();
+    res.sign = negative && !res.is_zero() ? -1 : 1;
     return res;
 }
 
 std::ostream &operator<<(std::ostream &s, big_integer const &a) {
-    s << to_string(a);
+    std::ios_base::fmtflags base = s.flags() & std::ios_base::basefield;
+    s << to_string(a, base == std::ios_base::hex ? 16 : base == std::ios_base::oct ? 8 : 10);
+    return s;
+}
+
+std::istream &operator>>(std::istream &s, big_integer &a) {
+    std::istream::sentry skipped_whitespace(s);
+    if (!skipped_whitespace) {
+        return s;
+    }
+    std::ios_base::fmtflags flags = s.flags() & std::ios_base::basefield;
+    unsigned base = flags == std::ios_base::hex ? 16 : flags == std::ios_base::oct ? 8 : 10;
+    // the characters are only collected here, the number is built once from all of them
+    std::string str;
+    std::streambuf *buf = s.rdbuf();
+    int c = buf->sgetc();
+    if (c == '-' || c == '+') {
+        str.push_back(static_cast<char>(c));
+        c = buf->snextc();
+    }
+    size_t sign_chars = str.size();
+    while (c != std::char_traits<char>::eof() && digit_value(static_cast<char>(c)) < base) {
+        str.push_back(static_cast<char>(c));
+        c = buf->snextc();
+    }
+    if (c == std::char_traits<char>::eof()) {
+        s.setstate(std::ios_base::eofbit);
+    }
+    if (str.size() == sign_chars) {
+        s.setstate(std::ios_base::failbit);
+        return s;
+    }
+    a = big_integer::parse(str.data(), str.size(), base);
     return s;
 }
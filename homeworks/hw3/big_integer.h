@@ -5,23 +5,41 @@
 #include <cstdint>
 #include <iosfwd>
 #include <utility>
-// #include <vector>
+#include <vector>
 #include "uintvector.h"
 
+namespace expr_nodes {
+    struct access;
+}
+
+template<typename Limb>
+struct basic_big_integer;
+
+template<size_t Bits, bool Signed>
+struct fixed_integer;
+
+struct big_integer_view;
 
 struct big_integer {
     big_integer();
 
     big_integer(big_integer const &other);
 
+    big_integer(big_integer &&other) noexcept;
+
     big_integer(int a);
 
     explicit big_integer(std::string const &str);
 
+    // Optional sign and digits of base 2, 8, 10, 16 or 32; letters of either case are digits above 9
+    big_integer(std::string const &str, unsigned base);
+
     ~big_integer();
 
     big_integer &operator=(big_integer const &other);
 
+    big_integer &operator=(big_integer &&other) noexcept;
+
     big_integer &operator+=(big_integer const &rhs);
 
     big_integer &operator-=(big_integer const &rhs);
@@ -56,6 +74,9 @@ struct big_integer {
 
     big_integer operator--(int);
 
+    // -1, 0 or 1 as a is less than, equal to or greater than b; backs all relational operators
+    friend int compare(big_integer const &a, big_integer const &b);
+
     friend bool operator==(big_integer const &a, big_integer const &b);
 
     friend bool operator!=(big_integer const &a, big_integer const &b);
@@ -72,12 +93,34 @@ struct big_integer {
 
     friend big_integer operator-(big_integer const &a, big_integer const &b);
 
+    // rvalue overloads reuse the storage of a temporary operand
+    friend big_integer operator+(big_integer &&a, big_integer const &b);
+
+    friend big_integer operator+(big_integer const &a, big_integer &&b);
+
+    friend big_integer operator+(big_integer &&a, big_integer &&b);
+
+    friend big_integer operator-(big_integer &&a, big_integer const &b);
+
+    friend big_integer operator-(big_integer &&a, big_integer &&b);
+
     friend big_integer operator*(big_integer const &a, big_integer const &b);
 
     friend big_integer operator/(big_integer const &a, big_integer const &b);
 
     friend big_integer operator%(big_integer const &a, big_integer const &b);
 
+    friend std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b);
+
+    // Greatest common divisor (non-negative) by Lehmer's algorithm over 62 leading bits,
+    // binary GCD once both numbers fit into 64 bits
+    friend big_integer gcd(big_integer const &a, big_integer const &b);
+
+    friend big_integer lcm(big_integer const &a, big_integer const &b);
+
+    // gcd(a, b) = a * x + b * y
+    friend big_integer extended_gcd(big_integer const &a, big_integer const &b, big_integer &x, big_integer &y);
+
     friend big_integer operator&(big_integer const &a, big_integer const &b);
 
     friend big_integer operator|(big_integer const &a, big_integer const &b);
@@ -90,27 +133,151 @@ struct big_integer {
 
     friend std::string to_string(big_integer const &a);
 
+    // Lowercase digits of base 2, 8, 10, 16 or 32
+    friend std::string to_string(big_integer const &a, unsigned base);
+
+    // Decimal, or hexadecimal and octal with std::hex and std::oct; collects all digits first
+    friend std::istream &operator>>(std::istream &s, big_integer &a);
+
+    // Product through number theoretic transform regardless of operand size
+    static big_integer mul_ntt(big_integer const &a, big_integer const &b);
+
+    // Opt-in parallel multiplication of huge numbers on `threads` threads, 1 turns it off.
+    // Products whose shorter operand is below min_task_digits digits are not split further.
+    // The batch operations below share the threads, splitting into tasks of min_task_digits digits
+    // at least. Not to be called while another thread multiplies.
+    static void set_multiplication_threads(size_t threads, size_t min_task_digits = 4096);
+
+    // Batch forms of res[i] = a[i] + b[i] and res[i] = a[i] - b[i] for i in [0..n), written over
+    // the digits each res[i] already owns; res may be a or b. Long batches are split over
+    // the threads, res[i] sharing digits with other numbers get copies of their own first.
+    static void add_many(big_integer const *a, big_integer const *b, big_integer *res, size_t n);
+
+    static void sub_many(big_integer const *a, big_integer const *b, big_integer *res, size_t n);
+
+    // a[0] + ... + a[n - 1] in two accumulators, of positive and negative terms, with no temporaries
+    static big_integer sum(big_integer const *a, size_t n);
+
+    // a[0] * ... * a[n - 1] by a balanced product tree: products of neighbours, level by level; 1 for n == 0
+    static big_integer product(big_integer const *a, size_t n);
+
+    // x % moduli[i] for i in [0..n) by a remainder tree: x is reduced modulo the nodes of the product
+    // tree of the moduli from the root down, each division takes a dividend about twice as long
+    // as the divisor. Throws if any modulus is zero.
+    static std::vector<big_integer> remainders(big_integer const &x, big_integer const *moduli, size_t n);
+
+    // this^exponent by binary powering within two buffers of the final size, squares by limbs::sqr
+    big_integer pow(unsigned exponent) const;
+
+    // floor(sqrt(this)), throws for negative numbers
+    big_integer isqrt() const;
+
+    // k-th root rounded toward zero, throws for k == 0 and even roots of negative numbers
+    big_integer iroot(unsigned k) const;
+
+    // Baillie-PSW test: trial division by the primes below 1000, a strong probable prime test
+    // to base 2 and a strong Lucas test with Selfridge's parameters, which no composite is known
+    // to pass; then `rounds` Miller-Rabin rounds to random bases. Numbers below 2 are not prime.
+    bool is_probable_prime(unsigned rounds = 0) const;
+
+    // the least probable prime above this
+    big_integer next_prime() const;
+
+    // Precomputed reduction modulo a fixed number, see big_integer_mod.h
+    struct modular_context;
+
+    // Binary form of export_bytes and import_bytes. Both encodings take the fewest bytes
+    // that leave the top bit for the sign: two's complement, or the sign bit over the magnitude.
+    enum class byte_order { little_endian, big_endian };
+
+    enum class sign_encoding { twos_complement, sign_magnitude };
+
+    std::vector<uint8_t> export_bytes(byte_order order = byte_order::little_endian,
+                                      sign_encoding encoding = sign_encoding::twos_complement) const;
+
+    // bytes[0..n) as written by export_bytes, any length; no bytes is zero
+    static big_integer import_bytes(uint8_t const *bytes, size_t n, byte_order order = byte_order::little_endian,
+                                    sign_encoding encoding = sign_encoding::twos_complement);
+
    private:
-    void shrink_to_fit();
+    friend struct expr_nodes::access;
+
+    friend struct big_integer_view;
 
-    big_integer get_adding_code() const;
+    template<typename Limb>
+    friend struct basic_big_integer;
 
-    big_integer complement_to_unsigned() const;
+    template<size_t Bits, bool Signed>
+    friend struct fixed_integer;
 
-    std::pair<big_integer, uint32_t> div_long_short(uint32_t x) const;
+    void shrink_to_fit();
 
-    big_integer logical_op(big_integer const &a, big_integer const &b,
-                           uint32_t (*op)(uint32_t a, uint32_t b),
-                           int32_t (*sign)(int32_t a, int32_t b)) const;
+    // Shifts by cnt bits, right shifts round toward minus infinity
+    static big_integer shift_left(big_integer const &a, size_t cnt);
 
-    bool smaller(big_integer const &dq, uint64_t k, uint64_t m) const;
+    static big_integer shift_right(big_integer const &a, size_t cnt);
 
-    uint32_t trial(uint64_t k, uint64_t m, uint64_t const d2) const;
+    void shift_left_in_place(size_t cnt);
 
-    void difference(big_integer const &dq, uint64_t k, uint64_t m);
+    void shift_right_in_place(size_t cnt);
+
+    // Digit-wise op over two's complement forms of a and b, converted on the fly
+    template<typename Op>
+    static big_integer logical_op(big_integer const &a, big_integer const &b, Op op);
 
     bool is_zero() const;
 
+    // bits of the magnitude without leading zeros, 0 for zero
+    size_t bit_length() const;
+
+    // Newton's iteration from an upper bound taken from the root of the top half of a, a > 0, k > 1
+    static big_integer iroot_magnitude(big_integer const &a, unsigned k);
+
+    // In-place kernels: |this| +- |rhs| with the given sign of rhs, |this| +- 1
+    big_integer &add_in_place(big_integer const &rhs, int32_t rhs_sign);
+
+    static big_integer signed_sum(big_integer const &a, big_integer const &b, int32_t b_sign);
+
+    // next[i] = level[2 i] * level[2 i + 1], the odd last number is copied; one level of a product tree
+    static void multiply_pairs(big_integer const *level, size_t n, std::vector<big_integer> &next);
+
+    // res[i] sharing their digits get copies before threads write them: the counts are not atomic
+    static void unshare(big_integer *res, size_t n);
+
+    // res = a + b_sign * |b| over the digits res already owns, res may be a or b
+    static void sum_into(big_integer &res, big_integer const &a, big_integer const &b, int32_t b_sign);
+
+    // Fast paths for magnitudes of at most two digits, computed in native 64- and 128-bit words
+    bool is_small() const;
+
+    uint64_t small_magnitude() const;
+
+    // this = s * (hi * 2^64 + lo), zero gets sign 1
+    void assign_small(uint64_t lo, uint64_t hi, int32_t s);
+
+    // res = a + b_sign * |b| for small a and b, res may be a
+    static void small_sum(big_integer &res, big_integer const &a, big_integer const &b, int32_t b_sign);
+
+    void increase_magnitude();
+
+    void decrease_magnitude();
+
+    // Radix conversion by divide and conquer over cached powers 10^(9 * 2^k)
+    static big_integer const &decimal_power(size_t k);
+
+    static big_integer from_decimal(char const *str, size_t len);
+
+    // Sign and digits in the given base, throws on anything else
+    static big_integer parse(char const *str, size_t len, unsigned base);
+
+    // Linear conversions for base 2^bits, bits is 1, 3, 4 or 5
+    static big_integer from_power_of_two(char const *str, size_t len, unsigned bits);
+
+    void to_power_of_two(std::string &out, unsigned bits) const;
+
+    // Appends digits of non-negative number, zero-padded to exactly `digits` characters if it is not 0
+    void to_decimal(std::string &out, size_t digits) const;
+
     // The number is expressed using naive 2-base sequence with 32-bit digits
     // and sign flag. Rightest element is the leading digit.
     int32_t sign;
@@ -121,12 +288,31 @@ big_integer operator+(big_integer const &a, big_integer const &b);
 
 big_integer operator-(big_integer const &a, big_integer const &b);
 
+big_integer operator+(big_integer &&a, big_integer const &b);
+
+big_integer operator+(big_integer const &a, big_integer &&b);
+
+big_integer operator+(big_integer &&a, big_integer &&b);
+
+big_integer operator-(big_integer &&a, big_integer const &b);
+
+big_integer operator-(big_integer &&a, big_integer &&b);
+
 big_integer operator*(big_integer const &a, big_integer const &b);
 
 big_integer operator/(big_integer const &a, big_integer const &b);
 
 big_integer operator%(big_integer const &a, big_integer const &b);
 
+// Quotient and remainder of truncating division in one pass
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b);
+
+big_integer gcd(big_integer const &a, big_integer const &b);
+
+big_integer lcm(big_integer const &a, big_integer const &b);
+
+big_integer extended_gcd(big_integer const &a, big_integer const &b, big_integer &x, big_integer &y);
+
 big_integer operator&(big_integer const &a, big_integer const &b);
 
 big_integer operator|(big_integer const &a, big_integer const &b);
@@ -137,6 +323,8 @@ big_integer operator<<(big_integer const &a, int b);
 
 big_integer operator>>(big_integer const &a, int b);
 
+int compare(big_integer const &a, big_integer const &b);
+
 bool operator==(big_integer const &a, big_integer const &b);
 
 bool operator!=(big_integer const &a, big_integer const &b);
@@ -151,6 +339,11 @@ bool operator>=(big_integer const &a, big_integer const &b);
 
 std::string to_string(big_integer const &a);
 
+std::string to_string(big_integer const &a, unsigned base);
+
+// Honors std::hex and std::oct like the built-in integers
 std::ostream &operator<<(std::ostream &s, big_integer const &a);
 
+std::istream &operator>>(std::istream &s, big_integer &a);
+
 #endif  // BIG_INTEGER_H
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <vector>
+#include "big_integer.h"
+#include "limb_parallel.h"
+
+namespace {
+    // Sum of magnitudes of one sign. Adding m digits touches only them and the carry:
+    // the length stays two digits above the longest term, enough for 2^64 terms.
+    struct accumulator {
+        std::vector<uint32_t> digits;
+
+        void add(uint32_t const *x, size_t m) {
+            if (digits.size() < m + 2) {
+                digits.resize(m + 2, 0);
+            }
+            limbs::add(digits.data(), digits.data(), digits.size(), x, m);
+        }
+
+        void add(accumulator const &other) {
+            size_t m = limbs::normalized_size(other.digits.data(), other.digits.size());
+            add(other.digits.data(), m);
+        }
+    };
+
+    // chunks of [0, n) for the threads, each with at least parallel_mul_threshold of the digits;
+    // the digits are counted only when there are threads to share the work
+    template<typename Digits, typename F>
+    void split(size_t n, Digits const &digits, F const &f) {
+        if (limbs::mul_threads() == 1) {
+            f(size_t(0), n);
+            return;
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < n; i++) {
+            total += digits(i);
+        }
+        limbs::parallel_for(n, n * limbs::parallel_mul_threshold / std::max<size_t>(total, 1), f);
+    }
+}
+
+void big_integer::unshare(big_integer *res, size_t n) {
+    if (limbs::mul_threads() == 1) {
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        res[i].value.mutable_data();
+    }
+}
+
+void big_integer::add_many(big_integer const *a, big_integer const *b, big_integer *res, size_t n) {
+    unshare(res, n);
+    auto digits = [a, b](size_t i) { return a[i].value.size() + b[i].value.size(); };
+    split(n, digits, [a, b, res](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            sum_into(res[i], a[i], b[i], b[i].sign);
+        }
+    });
+}
+
+void big_integer::sub_many(big_integer const *a, big_integer const *b, big_integer *res, size_t n) {
+    unshare(res, n);
+    auto digits = [a, b](size_t i) { return a[i].value.size() + b[i].value.size(); };
+    split(n, digits, [a, b, res](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            sum_into(res[i], a[i], b[i], -b[i].sign);
+        }
+    });
+}
+
+big_integer big_integer::sum(big_integer const *a, size_t n) {
+    size_t digits = 0;
+    for (size_t i = 0; i < n; i++) {
+        digits += a[i].value.size();
+    }
+    // one pair of accumulators per chunk, merged in order by the calling thread
+    size_t chunks = std::max<size_t>(1, std::min(limbs::mul_threads(), digits / std::max<size_t>(limbs::parallel_mul_threshold, 1)));
+    std::vector<accumulator> pos(chunks), neg(chunks);
+    {
+        limbs::task_group tasks(chunks > 1);
+        for (size_t c = 0; c < chunks; c++) {
+            tasks.run([a, n, c, chunks, &pos, &neg] {
+                for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; i++) {
+                    (a[i].sign > 0 ? pos : neg)[c].add(a[i].value.data(), a[i].value.size());
+                }
+            });
+        }
+        tasks.wait();
+    }
+    for (size_t c = 1; c < chunks; c++) {
+        pos[0].add(pos[c]);
+        neg[0].add(neg[c]);
+    }
+    auto to_big = [](accumulator const &acc) {
+        big_integer res;
+        if (!acc.digits.empty()) {
+            res.value.resize(acc.digits.size());
+            std::copy(acc.digits.begin(), acc.digits.end(), res.value.mutable_data());
+            res.shrink_to_fit();
+        }
+        return res;
+    };
+    big_integer res = to_big(pos[0]);
+    res -= to_big(neg[0]);
+    return res;
+}
+
+void big_integer::multiply_pairs(big_integer const *level, size_t n, std::vector<big_integer> &next) {
+    next.assign((n + 1) / 2, big_integer());
+    if (n % 2) {
+        next.back() = level[n - 1];
+    }
+    // long products of the upper levels may also split further by themselves
+    auto digits = [level](size_t i) { return level[2 * i].value.size() + level[2 * i + 1].value.size(); };
+    split(n / 2, digits, [level, &next](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            next[i] = level[2 * i] * level[2 * i + 1];
+        }
+    });
+}
+
+big_integer big_integer::product(big_integer const *a, size_t n) {
+    if (n <= 1) {
+        return n ? a[0] : big_integer(1);
+    }
+    std::vector<big_integer> level, next;
+    multiply_pairs(a, n, level);
+    while (level.size() > 1) {
+        multiply_pairs(level.data(), level.size(), next);
+        level.swap(next);
+    }
+    return level[0];
+}
+
+std::vector<big_integer> big_integer::remainders(big_integer const &x, big_integer const *moduli, size_t n) {
+    if (n == 0) {
+        return {};
+    }
+    // tree[0] are the moduli, each node above is the product of its two children
+    std::vector<std::vector<big_integer>> tree(1, std::vector<big_integer>(moduli, moduli + n));
+    while (tree.back().size() > 1) {
+        std::vector<big_integer> next;
+        multiply_pairs(tree.back().data(), tree.back().size(), next);
+        tree.push_back(std::move(next));
+    }
+    // x % m = (x % (m * m')) % m for truncating remainders too
+    std::vector<big_integer> rem(1, x % tree.back()[0]), next;
+    for (size_t k = tree.size() - 1; k-- > 0;) {
+        std::vector<big_integer> const &level = tree[k];
+        next.assign(level.size(), big_integer());
+        auto digits = [&rem](size_t i) { return rem[i / 2].value.size(); };
+        split(level.size(), digits, [&level, &rem, &next](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                big_integer const &parent = rem[i / 2];
+                if (parent.value.size() < level[i].value.size()) {
+                    // already reduced: the remainder would share the parent's digits with its sibling,
+                    // whose thread may be copying them too, so it gets digits of its own
+                    next[i].value.resize(parent.value.size());
+                    std::copy(parent.value.data(), parent.value.data() + parent.value.size(), next[i].value.mutable_data());
+                    next[i].sign = parent.sign;
+                } else {
+                    next[i] = parent % level[i];
+                }
+            }
+        });
+        rem.swap(next);
+    }
+    return rem;
+}
@@ -0,0 +1,636 @@
+// Timings of big_integer algorithms.
+// Usage: big_integer_benchmark [suite...], without arguments every suite is run.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "basic_big_integer.h"
+#include "big_integer.h"
+#include "big_integer_expr.h"
+#include "big_integer_mod.h"
+#include "big_integer_view.h"
+#include "fixed_integer.h"
+#include "limb_alloc.h"
+#include "limb_ops.h"
+#include "uintvector.h"
+
+namespace {
+    std::mt19937 rng(20180917);
+
+    std::vector<uint32_t> random_limbs(size_t n) {
+        std::vector<uint32_t> res(n);
+        for (auto &x : res) {
+            x = static_cast<uint32_t>(rng());
+        }
+        res.back() |= 1u << 31;
+        return res;
+    }
+
+    // Average time of one call in microseconds, repeats f for at least 50 ms
+    template<typename F>
+    double measure(F f) {
+        using clock = std::chrono::steady_clock;
+        size_t runs = 0;
+        auto start = clock::now();
+        std::chrono::duration<double, std::micro> elapsed(0);
+        do {
+            f();
+            runs++;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < 50000);
+        return elapsed.count() / double(runs);
+    }
+
+    void bench_mul() {
+        std::printf("mul: time of one n x n digit product, us (top level algorithm fixed)\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "schoolbook", "karatsuba", "toom3", "mul");
+        size_t const sizes[] = {16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 1024, 2048, 4096};
+        for (size_t n : sizes) {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<uint32_t> r(2 * n);
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { limbs::mul_basecase(r.data(), a.data(), n, b.data(), n); }),
+                        measure([&] { limbs::mul_karatsuba(r.data(), a.data(), n, b.data(), n); }),
+                        measure([&] { limbs::mul_toom3(r.data(), a.data(), n, b.data(), n); }),
+                        measure([&] { limbs::mul(r.data(), a.data(), n, b.data(), n); }));
+        }
+    }
+
+    void bench_ntt() {
+        std::printf("ntt: time of one n x n digit product, us\n");
+        std::printf("%8s %12s %12s %12s\n", "n", "toom3", "ntt", "mul");
+        size_t const sizes[] = {2048, 3072, 4096, 6144, 8192, 12288, 16384, 65536};
+        for (size_t n : sizes) {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<uint32_t> r(2 * n);
+            std::printf("%8zu %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { limbs::mul_toom3(r.data(), a.data(), n, b.data(), n); }),
+                        measure([&] { limbs::mul_ntt(r.data(), a.data(), n, b.data(), n); }),
+                        measure([&] { limbs::mul(r.data(), a.data(), n, b.data(), n); }));
+        }
+    }
+
+    void bench_div() {
+        std::printf("div: time of one 2n / n digit division, us\n");
+        std::printf("%8s %12s %12s\n", "n", "knuth", "divrem");
+        size_t const sizes[] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 4096, 16384};
+        for (size_t n : sizes) {
+            auto a = random_limbs(2 * n), d = random_limbs(n);
+            std::vector<uint32_t> q(n + 1), r(n);
+            size_t bz = limbs::bz_threshold;
+            limbs::bz_threshold = SIZE_MAX;
+            double knuth = measure([&] { limbs::divrem(q.data(), r.data(), a.data(), 2 * n, d.data(), n); });
+            limbs::bz_threshold = bz;
+            std::printf("%8zu %12.2f %12.2f\n", n, knuth,
+                        measure([&] { limbs::divrem(q.data(), r.data(), a.data(), 2 * n, d.data(), n); }));
+        }
+    }
+
+    std::string random_decimal(size_t len) {
+        std::string res(len, '0');
+        for (auto &c : res) {
+            c = static_cast<char>('0' + rng() % 10);
+        }
+        res[0] = '1';
+        return res;
+    }
+
+    void bench_radix() {
+        std::printf("radix: conversions of an n decimal digit number, us\n");
+        std::printf("%8s %12s %12s %12s %12s %12s\n", "n", "to_string", "from_string", "to hex", "from hex",
+                    "operator>>");
+        size_t const sizes[] = {100, 1000, 10000, 100000};
+        for (size_t n : sizes) {
+            std::string str = random_decimal(n);
+            big_integer a(str);
+            std::string hex = to_string(a, 16);
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { to_string(a); }),
+                        measure([&] { big_integer b(str); }),
+                        measure([&] { to_string(a, 16); }),
+                        measure([&] { big_integer b(hex, 16); }),
+                        measure([&] {
+                            std::istringstream in(str);
+                            in >> a;
+                        }));
+        }
+    }
+
+    big_integer random_big(size_t n, bool negative) {
+        auto d = random_limbs(n);
+        big_integer res = 0;
+        for (size_t i = n; i-- > 0;) {
+            res = (res << 32) + static_cast<int>(d[i] >> 1);
+            res = (res << 1) + static_cast<int>(d[i] & 1);
+        }
+        return negative ? -res : res;
+    }
+
+    void bench_expr() {
+        std::printf("expr: eager operators against fused expression templates on n digit operands, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "sum eager", "sum lazy", "mixed eager", "mixed lazy");
+        size_t const sizes[] = {4, 64, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = random_big(n, true), c = random_big(n, false),
+                    d = random_big(n / 2 + 1, true), e = random_big(n, true);
+            big_integer r;
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { r = a + b - c + d - e; }),
+                        measure([&] { r = lazy(a) + b - c + d - e; }),
+                        measure([&] { r = ((a << 7) ^ b) + (c & d) - (e >> 3); }),
+                        measure([&] { r = ((lazy(a) << 7) ^ b) + (lazy(c) & d) - (lazy(e) >> 3); }));
+        }
+    }
+
+    void bench_bitwise() {
+        std::printf("bitwise: mixed-sign operations on n digit operands, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "and", "or", "xor", "neg xor neg");
+        size_t const sizes[] = {10, 100, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = random_big(n - n / 10, true), c = random_big(n, true);
+            big_integer r;
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { r = a & b; }),
+                        measure([&] { r = a | b; }),
+                        measure([&] { r = a ^ b; }),
+                        measure([&] { r = b ^ c; }));
+        }
+    }
+
+    void bench_shift() {
+        std::printf("shift: shifts of n digit operands by n + 45 bits, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "<<", ">>", "neg >>", "<<= >>=");
+        size_t const sizes[] = {10, 100, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = random_big(n, true);
+            int sh = static_cast<int>(n) + 45;
+            big_integer r;
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { r = a << sh; }),
+                        measure([&] { r = a >> sh; }),
+                        measure([&] { r = b >> sh; }),
+                        measure([&] {
+                            a <<= sh;
+                            a >>= sh;
+                        }));
+        }
+    }
+
+    template<typename Num>
+    void bench_representation(char const *name, size_t n, big_integer const &a, big_integer const &b,
+                              big_integer const &c) {
+        Num x(a), y(b), z(c), r;
+        std::printf("%8zu %10s %12.2f %12.2f %12.2f\n", n, name,
+                    measure([&] { r = x + y; }),
+                    measure([&] { r = x * y; }),
+                    measure([&] { r = z / y; }));
+    }
+
+    void bench_limb() {
+        std::printf("limb: big_integer against basic_big_integer with 32 and 64-bit limbs,\n"
+                    "n 32-bit digit operands (2n digit dividend), us\n");
+        std::printf("%8s %10s %12s %12s %12s\n", "n", "type", "add", "mul", "div");
+        size_t const sizes[] = {4, 16, 64, 256, 1024, 4096};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = random_big(n, true), c = random_big(2 * n, false);
+            bench_representation<big_integer>("big", n, a, b, c);
+            bench_representation<basic_big_integer<uint32_t>>("basic32", n, a, b, c);
+            bench_representation<basic_big_integer<uint64_t>>("basic64", n, a, b, c);
+        }
+    }
+
+    void bench_compare() {
+        std::printf("compare: equal n digit operands and ones differing only in the lowest digit, us;\n"
+                    "sort of 1000 numbers of n digits with a common high half, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "==", "<", "neg <", "sort");
+        size_t const sizes[] = {4, 100, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = a + 1, c = -a, d = -b, e = b - 1;
+            big_integer high = random_big(n - n / 2, false) << static_cast<int>(32 * (n / 2));
+            std::vector<big_integer> numbers;
+            for (size_t i = 0; i < 1000; i++) {
+                numbers.push_back(high + random_big(n / 2 + 1, rng() % 2 == 0));
+            }
+            std::vector<big_integer> sorted;
+            volatile bool sink;
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { sink = a == e; }),
+                        measure([&] { sink = a < b; }),
+                        measure([&] { sink = c < d; }),
+                        measure([&] {
+                            sorted = numbers;
+                            std::sort(sorted.begin(), sorted.end());
+                        }));
+        }
+    }
+
+    // Horner-like chain of products and sums, every step makes fresh temporaries
+    big_integer polynomial(std::vector<big_integer> const &coefficients, big_integer const &x) {
+        big_integer r;
+        for (auto const &c : coefficients) {
+            r = r * x + c - (c >> 5);
+        }
+        return r;
+    }
+
+    void bench_alloc() {
+        std::printf("alloc: degree 16 polynomial of n digit coefficients at a 2 digit point,\n"
+                    "storage from the heap, the thread pool or an arena per evaluation, us\n");
+        std::printf("%8s %12s %12s %12s\n", "n", "heap", "pool", "arena");
+        size_t const sizes[] = {8, 32, 128, 1024};
+        for (size_t n : sizes) {
+            std::vector<big_integer> coefficients;
+            for (size_t i = 0; i < 16; i++) {
+                coefficients.push_back(random_big(n, i % 2 == 1));
+            }
+            big_integer x = random_big(2, false), r;
+            std::printf("%8zu %12.2f %12.2f %12.2f\n", n,
+                        measure([&] {
+                            limb_alloc::scoped_allocator scope(limb_alloc::heap());
+                            r = polynomial(coefficients, x);
+                        }),
+                        measure([&] { r = polynomial(coefficients, x); }),
+                        measure([&] {
+                            limb_alloc::arena scope;
+                            r = polynomial(coefficients, x);
+                        }));
+        }
+    }
+
+    void bench_cow() {
+        std::printf("cow: sharing and unsharing of n digit numbers, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "copy", "copy += 1", "copy 1000", "a -= a >> 1");
+        size_t const sizes[] = {4, 64, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), c;
+            std::vector<big_integer> numbers(1000, a), copies;
+            std::printf("%8zu %12.3f %12.3f %12.2f %12.2f\n", n,
+                        measure([&] { c = a; }),
+                        measure([&] {
+                            c = a;
+                            c += 1;
+                        }),
+                        measure([&] { copies = numbers; }),
+                        measure([&] {
+                            c = a;
+                            c -= c >> 1;
+                        }));
+        }
+    }
+
+    void bench_vector() {
+        std::printf("vector: uintvector growth as big_integer does it, us\n"
+                    "push_back of n digits, the same after reserve, n doublings x += x (carry digits),\n"
+                    "n moves out of a number and back (moved-from one gets a zero digit)\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "push_back", "reserved", "x += x", "move");
+        size_t const sizes[] = {4, 64, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false);
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] {
+                            uintvector v;
+                            for (size_t i = 0; i < n; i++) {
+                                v.push_back(static_cast<uint32_t>(i));
+                            }
+                        }),
+                        measure([&] {
+                            uintvector v;
+                            v.reserve(n);
+                            for (size_t i = 0; i < n; i++) {
+                                v.push_back(static_cast<uint32_t>(i));
+                            }
+                        }),
+                        measure([&] {
+                            big_integer x(1);
+                            for (size_t i = 0; i < n; i++) {
+                                x += x;
+                            }
+                        }),
+                        measure([&] {
+                            for (size_t i = 0; i < n; i++) {
+                                big_integer b = std::move(a);
+                                a = std::move(b);
+                            }
+                        }));
+        }
+    }
+
+    void bench_mod() {
+        std::printf("mod: modular exponentiation with an n digit modulus and exponent, us;\n"
+                    "square and multiply with operator%% against modular_context\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "naive", "montgomery", "barrett", "mul_mod");
+        size_t const sizes[] = {8, 16, 32, 64, 128};
+        for (size_t n : sizes) {
+            big_integer odd = random_big(n, false) | 1, even = odd - 1;
+            big_integer base = random_big(n - 1, false), exponent = random_big(n, false);
+            big_integer::modular_context mont(odd), barrett(even);
+            big_integer r;
+            std::printf("%8zu %12.1f %12.1f %12.1f %12.2f\n", n,
+                        measure([&] {
+                            big_integer b = base, e = exponent;
+                            r = 1;
+                            while (e > 0) {
+                                if ((e & 1) == 1) {
+                                    r = r * b % odd;
+                                }
+                                b = b * b % odd;
+                                e >>= 1;
+                            }
+                        }),
+                        measure([&] { r = mont.pow_mod(base, exponent); }),
+                        measure([&] { r = barrett.pow_mod(base, exponent); }),
+                        measure([&] { r = mont.mul_mod(base, exponent); }));
+        }
+    }
+
+    void bench_sqr() {
+        std::printf("sqr: n digit square against the general product, us\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "mul_basecase", "sqr_basecase", "mul", "sqr");
+        size_t const sizes[] = {8, 16, 32, 48, 64, 96, 128, 256, 1024};
+        for (size_t n : sizes) {
+            auto a = random_limbs(n);
+            std::vector<uint32_t> r(2 * n);
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { limbs::mul_basecase(r.data(), a.data(), n, a.data(), n); }),
+                        measure([&] { limbs::sqr_basecase(r.data(), a.data(), n); }),
+                        measure([&] { limbs::mul(r.data(), a.data(), n, a.data(), n); }),
+                        measure([&] { limbs::sqr(r.data(), a.data(), n); }));
+        }
+    }
+
+    void bench_root() {
+        std::printf("root: powers and roots of n digit numbers, us;\n"
+                    "a^e with e = 64 by repeated *= and by pow, isqrt and iroot(3) of a^e\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "n", "*= loop", "pow", "isqrt", "iroot(3)");
+        size_t const sizes[] = {1, 4, 16, 64};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), r;
+            big_integer big = a.pow(64);
+            std::printf("%8zu %12.1f %12.1f %12.1f %12.1f\n", n,
+                        measure([&] {
+                            r = 1;
+                            for (int i = 0; i < 64; i++) {
+                                r *= a;
+                            }
+                        }),
+                        measure([&] { r = a.pow(64); }),
+                        measure([&] { r = big.isqrt(); }),
+                        measure([&] { r = big.iroot(3); }));
+        }
+    }
+
+    void bench_gcd() {
+        std::printf("gcd: gcd of random n digit numbers, us\n");
+        std::printf("%8s %12s %12s %12s\n", "n", "euclid %", "gcd", "extended");
+        size_t const sizes[] = {2, 4, 16, 64, 256, 1024};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, false), b = random_big(n, true), r, x, y;
+            std::printf("%8zu %12.1f %12.1f %12.1f\n", n,
+                        measure([&] {
+                            big_integer u = a, v = -b;
+                            while (v != 0) {
+                                u %= v;
+                                std::swap(u, v);
+                            }
+                            r = u;
+                        }),
+                        measure([&] { r = gcd(a, b); }),
+                        measure([&] { r = extended_gcd(a, b, x, y); }));
+        }
+    }
+
+    void bench_small() {
+        std::printf("small: mixed one or two and 16 digit operands, ns per operation\n");
+        std::printf("%8s %10s %10s %10s %10s\n", "large %", "a + b", "a - b", "a * b", "a / b");
+        size_t const COUNT = 1000;
+        int const shares[] = {0, 10, 50, 100};
+        for (int share : shares) {
+            std::vector<big_integer> a, b;
+            for (size_t i = 0; i < COUNT; i++) {
+                bool large = int(rng() % 100) < share;
+                a.push_back(random_big(large ? 16 : 1 + rng() % 2, rng() % 2));
+                b.push_back(random_big(large ? 8 : 1 + rng() % 2, rng() % 2));
+            }
+            big_integer r;
+            double k = 1000.0 / double(COUNT);
+            std::printf("%8d %10.1f %10.1f %10.1f %10.1f\n", share,
+                        k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] + b[i]; }),
+                        k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] - b[i]; }),
+                        k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] * b[i]; }),
+                        k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] / b[i]; }));
+        }
+    }
+
+    void bench_parallel() {
+        std::printf("parallel: n x n digit product on t threads, ms\n");
+        std::printf("%8s %10s %10s %10s %10s\n", "n", "t = 1", "t = 2", "t = 4", "t = 8");
+        size_t const sizes[] = {4096, 16384, 65536, 262144};
+        size_t const threads[] = {1, 2, 4, 8};
+        for (size_t n : sizes) {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<uint32_t> r(2 * n);
+            std::printf("%8zu", n);
+            for (size_t t : threads) {
+                big_integer::set_multiplication_threads(t);
+                std::printf(" %10.2f", measure([&] { limbs::mul(r.data(), a.data(), n, b.data(), n); }) / 1000);
+            }
+            std::printf("\n");
+        }
+        big_integer::set_multiplication_threads(1);
+    }
+
+    void bench_bytes() {
+        std::printf("bytes: binary and decimal round trips of n digit numbers, us\n");
+        std::printf("%8s %12s %12s %12s %12s %12s\n", "n", "to_string", "from string", "export", "import",
+                    "view");
+        size_t const sizes[] = {4, 64, 1000, 10000};
+        for (size_t n : sizes) {
+            big_integer a = random_big(n, true), r;
+            std::string s = to_string(a);
+            auto bytes = a.export_bytes();
+            auto limbs = random_limbs(n);
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", n,
+                        measure([&] { s = to_string(a); }),
+                        measure([&] { r = big_integer(s); }),
+                        measure([&] { bytes = a.export_bytes(); }),
+                        measure([&] { r = big_integer::import_bytes(bytes.data(), bytes.size()); }),
+                        measure([&] { r = big_integer_view(limbs.data(), n) + 1; }));
+        }
+    }
+
+    void bench_fixed() {
+        std::printf("fixed: 256 bit operands, fixed_integer<256> against big_integer, ns per operation\n");
+        std::printf("%12s %10s %10s %10s %10s %10s\n", "", "a + b", "a * b", "a / b", "a << 67", "a < b");
+        size_t const COUNT = 1000;
+        std::vector<big_integer> a, b;
+        std::vector<fixed_integer<256>> fa, fb;
+        for (size_t i = 0; i < COUNT; i++) {
+            a.push_back(random_big(7, rng() % 2));
+            b.push_back(random_big(1 + rng() % 4, rng() % 2));
+            fa.emplace_back(a.back());
+            fb.emplace_back(b.back());
+        }
+        big_integer r;
+        fixed_integer<256> fr;
+        bool less = false;
+        double k = 1000.0 / double(COUNT);
+        // fixed results are accumulated, otherwise the unused ones are optimized away
+        std::printf("%12s %10.1f %10.1f %10.1f %10.1f %10.1f\n", "fixed",
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) fr ^= fa[i] + fb[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) fr ^= fa[i] * fb[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) fr ^= fa[i] / fb[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) fr ^= fa[i] << 67; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) less ^= fa[i] < fb[i]; }));
+        std::printf("%12s %10.1f %10.1f %10.1f %10.1f %10.1f\n", "big_integer",
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] + b[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] * b[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] / b[i]; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) r = a[i] << 67; }),
+                    k * measure([&] { for (size_t i = 0; i < COUNT; i++) less ^= a[i] < b[i]; }));
+        if (less && fr == 0) {
+            std::printf("\n");
+        }
+    }
+
+    void bench_batch() {
+        std::printf("batch: n operands of 1 to d digits, loop of operators against batch calls, us\n");
+        std::printf("%8s %4s %12s %12s %12s %12s %12s %12s\n", "n", "d", "r[i] = a + b", "add_many",
+                    "s += a[i]", "sum", "p *= a[i]", "product");
+        size_t const counts[] = {1000, 100000};
+        size_t const lengths[] = {2, 16};
+        for (size_t n : counts) {
+            for (size_t d : lengths) {
+                std::vector<big_integer> a, b, r(n);
+                for (size_t i = 0; i < n; i++) {
+                    a.push_back(random_big(1 + rng() % d, rng() % 2));
+                    b.push_back(random_big(1 + rng() % d, rng() % 2));
+                }
+                big_integer s;
+                // the running product of 10^5 numbers is too slow to measure
+                size_t m = std::min<size_t>(n, 1000);
+                std::printf("%8zu %4zu %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", n, d,
+                            measure([&] { for (size_t i = 0; i < n; i++) r[i] = a[i] + b[i]; }),
+                            measure([&] { big_integer::add_many(a.data(), b.data(), r.data(), n); }),
+                            measure([&] {
+                                s = 0;
+                                for (size_t i = 0; i < n; i++) s += a[i];
+                            }),
+                            measure([&] { s = big_integer::sum(a.data(), n); }),
+                            measure([&] {
+                                s = 1;
+                                for (size_t i = 0; i < m; i++) s *= a[i];
+                            }),
+                            measure([&] { s = big_integer::product(a.data(), m); }));
+            }
+        }
+    }
+
+    void bench_tree() {
+        std::printf("tree: x of 16 k digits modulo k numbers of 16 digits, us\n");
+        std::printf("%8s %12s %12s\n", "k", "x % m[i]", "remainders");
+        size_t const counts[] = {16, 256, 4096};
+        for (size_t k : counts) {
+            std::vector<big_integer> moduli, rem(k);
+            for (size_t i = 0; i < k; i++) {
+                moduli.push_back(random_big(16, false));
+            }
+            big_integer x = random_big(16 * k, true);
+            std::printf("%8zu %12.1f %12.1f\n", k,
+                        measure([&] { for (size_t i = 0; i < k; i++) rem[i] = x % moduli[i]; }),
+                        measure([&] { rem = big_integer::remainders(x, moduli.data(), k); }));
+        }
+    }
+
+    void bench_prime() {
+        std::printf("prime: probable primes of the given length, ms\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "bits", "pow_mod", "bpsw", "+10 rounds", "next_prime");
+        size_t const lengths[] = {1024, 2048, 4096};
+        for (size_t bits : lengths) {
+            big_integer start = random_big(bits / 32, false), p;
+            double next = measure([&] { p = start.next_prime(); }) / 1000;
+            big_integer::modular_context ctx(p);
+            bool prime = true;
+            std::printf("%8zu %12.3f %12.3f %12.3f %12.3f\n", bits,
+                        measure([&] { start = ctx.pow_mod(2, p - 1); }) / 1000,
+                        measure([&] { prime &= p.is_probable_prime(); }) / 1000,
+                        measure([&] { prime &= p.is_probable_prime(10); }) / 1000, next);
+            if (!prime) {
+                std::printf("not a prime\n");
+            }
+        }
+    }
+
+    void bench_kernels() {
+#ifdef BIG_INTEGER_ASM
+        std::printf("kernels: assembly limb kernels, ns per digit\n");
+#else
+        std::printf("kernels: portable limb kernels, ns per digit\n");
+#endif
+        std::printf("%8s %10s %10s %10s %10s %10s\n", "n", "add_n", "sub_n", "mul_1", "addmul_1", "submul_1");
+        size_t const sizes[] = {8, 64, 1000, 10000};
+        for (size_t n : sizes) {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<uint32_t> r(n);
+            double k = 1000.0 / double(n);
+            std::printf("%8zu %10.3f %10.3f %10.3f %10.3f %10.3f\n", n,
+                        k * measure([&] { limbs::add_n(r.data(), a.data(), b.data(), n); }),
+                        k * measure([&] { limbs::sub_n(r.data(), a.data(), b.data(), n); }),
+                        k * measure([&] { limbs::mul_1(r.data(), a.data(), n, b[0]); }),
+                        k * measure([&] { limbs::addmul_1(r.data(), a.data(), n, b[0]); }),
+                        k * measure([&] { limbs::submul_1(r.data(), a.data(), n, b[0]); }));
+        }
+    }
+
+    struct suite {
+        char const *name;
+
+        void (*run)();
+    };
+
+    suite const SUITES[] = {
+            {"kernels", bench_kernels},
+            {"mul", bench_mul},
+            {"ntt", bench_ntt},
+            {"div", bench_div},
+            {"radix", bench_radix},
+            {"expr", bench_expr},
+            {"bitwise", bench_bitwise},
+            {"shift", bench_shift},
+            {"limb", bench_limb},
+            {"compare", bench_compare},
+            {"alloc", bench_alloc},
+            {"cow", bench_cow},
+            {"vector", bench_vector},
+            {"mod", bench_mod},
+            {"sqr", bench_sqr},
+            {"root", bench_root},
+            {"gcd", bench_gcd},
+            {"small", bench_small},
+            {"parallel", bench_parallel},
+            {"bytes", bench_bytes},
+            {"fixed", bench_fixed},
+            {"batch", bench_batch},
+            {"tree", bench_tree},
+            {"prime", bench_prime},
+    };
+}
+
+int main(int argc, char **argv) {
+    for (auto const &s : SUITES) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++) {
+            selected |= std::strcmp(argv[i], s.name) == 0;
+        }
+        if (selected) {
+            s.run();
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
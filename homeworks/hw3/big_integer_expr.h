@@ -0,0 +1,466 @@
+#ifndef BIG_INTEGER_EXPR_H
+#define BIG_INTEGER_EXPR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "big_integer.h"
+#include "limb_ops.h"
+
+// Opt-in expression templates over big_integer.
+// Chains of +, -, unary -, <<, >>, &, | and ^ started with lazy() are fused:
+// each node streams digits of its value in two's complement block by block,
+// the whole tree is evaluated in one pass into a single allocated result.
+// Multiplication is not streamable, so * evaluates both sides eagerly.
+//
+//     big_integer r = lazy(a) * b + lazy(c) * d - (e << 7);
+//
+// Leaves keep big_integer copies, which share digits with the originals.
+namespace expr_nodes {
+    // Nodes provide:
+    //   bound()       - number of digits enough for the value in two's complement,
+    //                   digits after it are copies of the sign bit;
+    //   start()       - resets the node to the lowest digit;
+    //   fill(out, k)  - writes the next k <= BLOCK two's complement digits;
+    //   view(k, allow_negated, negated)
+    //                 - the next k digits in place if a leaf stores them as they are,
+    //                   nullptr and no advance otherwise. With allow_negated digits of
+    //                   a negative leaf are returned as well: they are its magnitude,
+    //                   to be subtracted. Views of a node always precede its fills.
+    size_t const BLOCK = 256;
+
+    struct access {
+        static uint32_t const *data(big_integer const &a) {
+            return a.value.data();
+        }
+
+        static size_t size(big_integer const &a) {
+            return a.value.size();
+        }
+
+        static bool negative(big_integer const &a) {
+            return a.sign < 0;
+        }
+
+        template<typename Node>
+        static big_integer evaluate(Node node) {
+            size_t n = node.bound();
+            big_integer res;
+            res.value.resize(n);
+            uint32_t *d = res.value.mutable_data();
+            node.start();
+            for (size_t i = 0; i < n; i += BLOCK) {
+                node.fill(d + i, std::min(BLOCK, n - i));
+            }
+            if (d[n - 1] >> 31) {
+                // magnitude ~x + 1: low zero digits stay, the first nonzero one is negated
+                size_t j = 0;
+                while (d[j] == 0) {
+                    j++;
+                }
+                d[j] = 0u - d[j];
+                for (size_t i = j + 1; i < n; i++) {
+                    d[i] = ~d[i];
+                }
+                res.sign = -1;
+            }
+            res.shrink_to_fit();
+            if (res.is_zero()) {
+                res.sign = 1;
+            }
+            return res;
+        }
+    };
+
+    struct leaf {
+        explicit leaf(big_integer const &a) : num(a) {}
+
+        size_t bound() const {
+            return access::size(num) + 1;
+        }
+
+        void start() {
+            pos = 0;
+            negative = access::negative(num);
+            carry = 1;
+        }
+
+        uint32_t const *view(size_t k, bool allow_negated, bool &negated) {
+            if ((negative && !allow_negated) || pos + k > access::size(num)) {
+                return nullptr;
+            }
+            negated = negative;
+            pos += k;
+            // the caller subtracts these digits exactly, the rest of -x continues as ~x + 1
+            carry = 1;
+            return access::data(num) + pos - k;
+        }
+
+        void fill(uint32_t *out, size_t k) {
+            uint32_t const *digits = access::data(num);
+            size_t size = access::size(num);
+            size_t avail = pos < size ? std::min(k, size - pos) : 0;
+            std::copy(digits + pos, digits + pos + avail, out);
+            std::fill(out + avail, out + k, 0);
+            pos += k;
+            if (negative) {
+                // ~x + 1 with the carry running through the blocks
+                for (size_t i = 0; i < k; i++) {
+                    out[i] = ~out[i];
+                }
+                carry = limbs::add_1(out, out, k, carry);
+            }
+        }
+
+        big_integer num;
+        size_t pos = 0;
+        bool negative = false;
+        uint32_t carry = 0;
+    };
+
+    // Next k digits of a node, read in place when possible or written to buf
+    template<typename Node>
+    uint32_t const *operand(Node &node, uint32_t *buf, size_t k, bool allow_negated, bool &negated) {
+        negated = false;
+        uint32_t const *res = node.view(k, allow_negated, negated);
+        if (res) {
+            return res;
+        }
+        node.fill(buf, k);
+        return buf;
+    }
+
+    // a + b, or a - b
+    template<typename L, typename R, bool Subtract>
+    struct sum {
+        sum(L const &l, R const &r) : lhs(l), rhs(r) {}
+
+        size_t bound() const {
+            return std::max(lhs.bound(), rhs.bound()) + 1;
+        }
+
+        void start() {
+            lhs.start();
+            rhs.start();
+            carry = 0;
+        }
+
+        uint32_t const *view(size_t, bool, bool &) {
+            return nullptr;
+        }
+
+        // out = (+-a) + (+-b) + carry, the new carry is the signed excess over 2^(32k)
+        void fill(uint32_t *out, size_t k) {
+            uint32_t tmp[BLOCK];
+            bool neg_a, neg_b;
+            uint32_t const *a = operand(lhs, out, k, true, neg_a);
+            uint32_t const *b = operand(rhs, tmp, k, true, neg_b);
+            neg_b ^= Subtract;
+            int c;
+            if (neg_a == neg_b) {
+                c = static_cast<int>(limbs::add_n(out, a, b, k));
+                if (neg_a) {
+                    // -s = ~s + 1 - 2^(32k)
+                    for (size_t i = 0; i < k; i++) {
+                        out[i] = ~out[i];
+                    }
+                    c = -1 - c;
+                    carry++;
+                }
+            } else if (neg_b) {
+                c = -static_cast<int>(limbs::sub_n(out, a, b, k));
+            } else {
+                c = -static_cast<int>(limbs::sub_n(out, b, a, k));
+            }
+            if (carry > 0) {
+                c += static_cast<int>(limbs::add_1(out, out, k, static_cast<uint32_t>(carry)));
+            } else if (carry < 0) {
+                c -= static_cast<int>(limbs::sub_1(out, out, k, static_cast<uint32_t>(-carry)));
+            }
+            carry = c;
+        }
+
+        L lhs;
+        R rhs;
+        int carry = 0;
+    };
+
+    template<typename E>
+    struct negate {
+        explicit negate(E const &e) : arg(e) {}
+
+        size_t bound() const {
+            return arg.bound() + 1;
+        }
+
+        void start() {
+            arg.start();
+            carry = 1;
+        }
+
+        uint32_t const *view(size_t, bool, bool &) {
+            return nullptr;
+        }
+
+        void fill(uint32_t *out, size_t k) {
+            arg.fill(out, k);
+            for (size_t i = 0; i < k; i++) {
+                out[i] = ~out[i];
+            }
+            carry = limbs::add_1(out, out, k, carry);
+        }
+
+        E arg;
+        uint32_t carry = 0;
+    };
+
+    template<typename L, typename R, typename Op>
+    struct bitwise {
+        bitwise(L const &l, R const &r) : lhs(l), rhs(r) {}
+
+        size_t bound() const {
+            return std::max(lhs.bound(), rhs.bound());
+        }
+
+        void start() {
+            lhs.start();
+            rhs.start();
+        }
+
+        uint32_t const *view(size_t, bool, bool &) {
+            return nullptr;
+        }
+
+        void fill(uint32_t *out, size_t k) {
+            uint32_t tmp[BLOCK];
+            bool negated;
+            uint32_t const *a = operand(lhs, out, k, false, negated);
+            uint32_t const *b = operand(rhs, tmp, k, false, negated);
+            for (size_t i = 0; i < k; i++) {
+                out[i] = Op()(a[i], b[i]);
+            }
+        }
+
+        L lhs;
+        R rhs;
+    };
+
+    // Arithmetic shift by cnt bits, to the left if cnt > 0 and to the right (floor) otherwise
+    template<typename E>
+    struct shift {
+        shift(E const &e, int64_t cnt) : arg(e), cnt(cnt) {}
+
+        size_t bound() const {
+            size_t n = arg.bound();
+            if (cnt >= 0) {
+                return n + (size_t(cnt) + 31) / 32;
+            }
+            size_t digits = size_t(-cnt) / 32;
+            return n > digits ? n - digits : 1;
+        }
+
+        void start() {
+            arg.start();
+            uint32_t skipped[BLOCK];
+            if (cnt >= 0) {
+                zeros = size_t(cnt) / 32;
+                bits = unsigned(cnt % 32);
+                prev = 0;
+            } else {
+                // the lowest digits are dropped, one more is kept as lookahead
+                zeros = 0;
+                bits = unsigned(-cnt % 32);
+                for (size_t digits = size_t(-cnt) / 32; digits > 0;) {
+                    size_t k = std::min(BLOCK, digits);
+                    arg.fill(skipped, k);
+                    digits -= k;
+                }
+                arg.fill(&prev, 1);
+            }
+        }
+
+        uint32_t const *view(size_t, bool, bool &) {
+            return nullptr;
+        }
+
+        void fill(uint32_t *out, size_t k) {
+            size_t z = std::min(zeros, k);
+            std::fill(out, out + z, 0);
+            zeros -= z;
+            out += z;
+            k -= z;
+            if (k == 0) {
+                return;
+            }
+            if (cnt >= 0) {
+                arg.fill(out, k);
+                if (bits) {
+                    uint32_t high = limbs::lshift(out, out, k, bits);
+                    out[0] |= prev;
+                    prev = high;
+                }
+            } else {
+                // tmp holds the lookahead digit followed by k new ones
+                uint32_t tmp[BLOCK + 1];
+                tmp[0] = prev;
+                arg.fill(tmp + 1, k);
+                prev = tmp[k];
+                if (bits) {
+                    limbs::rshift(tmp, tmp, k + 1, bits);
+                }
+                std::copy(tmp, tmp + k, out);
+            }
+        }
+
+        E arg;
+        int64_t cnt;
+        size_t zeros = 0;
+        unsigned bits = 0;
+        uint32_t prev = 0;
+    };
+
+    struct and_op {
+        uint32_t operator()(uint32_t a, uint32_t b) const { return a & b; }
+    };
+
+    struct or_op {
+        uint32_t operator()(uint32_t a, uint32_t b) const { return a | b; }
+    };
+
+    struct xor_op {
+        uint32_t operator()(uint32_t a, uint32_t b) const { return a ^ b; }
+    };
+}
+
+template<typename Node>
+struct big_integer_expr {
+    explicit big_integer_expr(Node const &node) : node(node) {}
+
+    operator big_integer() const {
+        return expr_nodes::access::evaluate(node);
+    }
+
+    Node node;
+};
+
+inline big_integer_expr<expr_nodes::leaf> lazy(big_integer const &a) {
+    return big_integer_expr<expr_nodes::leaf>(expr_nodes::leaf(a));
+}
+
+namespace expr_nodes {
+    // Operands of mixed operators: expressions as they are, numbers as leaves
+    template<typename Node>
+    Node const &node_of(big_integer_expr<Node> const &e) {
+        return e.node;
+    }
+
+    inline leaf node_of(big_integer const &a) {
+        return leaf(a);
+    }
+
+    template<typename T>
+    struct node_type {
+        typedef leaf type;
+    };
+
+    template<typename Node>
+    struct node_type<big_integer_expr<Node>> {
+        typedef Node type;
+    };
+
+    template<typename T>
+    struct is_expr {
+        static const bool value = false;
+    };
+
+    template<typename Node>
+    struct is_expr<big_integer_expr<Node>> {
+        static const bool value = true;
+    };
+
+    // Binary operators take part in overload resolution when at least one operand
+    // is an expression, the other one may be anything convertible to big_integer
+    template<typename L, typename R, template<typename, typename> class Make>
+    struct binary {
+        typedef typename std::conditional<is_expr<L>::value, L const &, big_integer>::type lhs_arg;
+        typedef typename std::conditional<is_expr<R>::value, R const &, big_integer>::type rhs_arg;
+        typedef typename Make<typename node_type<L>::type, typename node_type<R>::type>::type node;
+        typedef big_integer_expr<node> type;
+    };
+
+    template<typename L, typename R>
+    struct any_expr {
+        static const bool value = is_expr<L>::value || is_expr<R>::value;
+    };
+
+    template<typename L, typename R>
+    struct make_add {
+        typedef sum<L, R, false> type;
+    };
+
+    template<typename L, typename R>
+    struct make_sub {
+        typedef sum<L, R, true> type;
+    };
+
+    template<typename L, typename R>
+    struct make_and {
+        typedef bitwise<L, R, and_op> type;
+    };
+
+    template<typename L, typename R>
+    struct make_or {
+        typedef bitwise<L, R, or_op> type;
+    };
+
+    template<typename L, typename R>
+    struct make_xor {
+        typedef bitwise<L, R, xor_op> type;
+    };
+}
+
+#define BIG_INTEGER_EXPR_BINARY(op, make)                                                              \
+    template<typename L, typename R>                                                                   \
+    typename std::enable_if<expr_nodes::any_expr<L, R>::value,                                         \
+            expr_nodes::binary<L, R, expr_nodes::make>>::type::type operator op(L const &a, R const &b) { \
+        typedef expr_nodes::binary<L, R, expr_nodes::make> info;                                       \
+        typename info::lhs_arg x = a;                                                                  \
+        typename info::rhs_arg y = b;                                                                  \
+        return typename info::type(typename info::node(expr_nodes::node_of(x), expr_nodes::node_of(y))); \
+    }
+
+BIG_INTEGER_EXPR_BINARY(+, make_add)
+
+BIG_INTEGER_EXPR_BINARY(-, make_sub)
+
+BIG_INTEGER_EXPR_BINARY(&, make_and)
+
+BIG_INTEGER_EXPR_BINARY(|, make_or)
+
+BIG_INTEGER_EXPR_BINARY(^, make_xor)
+
+#undef BIG_INTEGER_EXPR_BINARY
+
+template<typename Node>
+big_integer_expr<expr_nodes::negate<Node>> operator-(big_integer_expr<Node> const &e) {
+    return big_integer_expr<expr_nodes::negate<Node>>(expr_nodes::negate<Node>(e.node));
+}
+
+template<typename Node>
+big_integer_expr<expr_nodes::shift<Node>> operator<<(big_integer_expr<Node> const &e, int cnt) {
+    return big_integer_expr<expr_nodes::shift<Node>>(expr_nodes::shift<Node>(e.node, cnt));
+}
+
+template<typename Node>
+big_integer_expr<expr_nodes::shift<Node>> operator>>(big_integer_expr<Node> const &e, int cnt) {
+    return big_integer_expr<expr_nodes::shift<Node>>(expr_nodes::shift<Node>(e.node, -int64_t(cnt)));
+}
+
+// Products are evaluated at once and continue the chain as leaves
+template<typename L, typename R>
+typename std::enable_if<expr_nodes::any_expr<L, R>::value, big_integer_expr<expr_nodes::leaf>>::type operator*(L const &a, R const &b) {
+    return lazy(big_integer(a) * big_integer(b));
+}
+
+#endif // BIG_INTEGER_EXPR_H
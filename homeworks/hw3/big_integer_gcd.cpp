@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "big_integer.h"
+#include "limb_ops.h"
+
+namespace {
+    // Magnitude without leading zero digits, empty for zero
+    typedef std::vector<uint32_t> digits;
+
+    void normalize(digits &x) {
+        x.resize(limbs::normalized_size(x.data(), x.size()));
+    }
+
+    size_t bit_length(digits const &x) {
+        return 32 * x.size() - static_cast<size_t>(__builtin_clz(x.back()));
+    }
+
+    uint64_t digit(digits const &x, size_t i) {
+        return i < x.size() ? x[i] : 0;
+    }
+
+    uint64_t to_uint64(digits const &x) {
+        return digit(x, 0) | digit(x, 1) << 32;
+    }
+
+    // 62 bits of x starting from bit shift
+    uint64_t bits_at(digits const &x, size_t shift) {
+        size_t i = shift / 32, off = shift % 32;
+        uint64_t v = (digit(x, i) | digit(x, i + 1) << 32) >> off;
+        if (off) {
+            v |= digit(x, i + 2) << (64 - off);
+        }
+        return v & ((uint64_t(1) << 62) - 1);
+    }
+
+    // (x, y) -> (a x + b y, c x + d y)
+    struct cofactors {
+        int64_t a, b, c, d;
+    };
+
+    int64_t const COFACTOR_LIMIT = int64_t(1) << 32;
+
+    // Knuth's algorithm L on the leading bits xh >= yh of x and y: a quotient is taken only
+    // when both bounds of the true one agree, cofactors stay below 2^32.
+    // Returns false when not even the first quotient is certain.
+    bool lehmer_cofactors(int64_t xh, int64_t yh, cofactors &m) {
+        m = {1, 0, 0, 1};
+        while (yh + m.c > 0 && yh + m.d > 0) {
+            int64_t q = (xh + m.a) / (yh + m.c);
+            if (q != (xh + m.b) / (yh + m.d)) {
+                break;
+            }
+            // |new c| = |a| + q |c|, |new d| = |b| + q |d|
+            int64_t abs_c = std::abs(m.c), abs_d = std::abs(m.d);
+            if ((abs_c && q > (COFACTOR_LIMIT - std::abs(m.a)) / abs_c) ||
+                (abs_d && q > (COFACTOR_LIMIT - std::abs(m.b)) / abs_d) ||
+                std::abs(m.a) + q * abs_c >= COFACTOR_LIMIT || std::abs(m.b) + q * abs_d >= COFACTOR_LIMIT) {
+                break;
+            }
+            m = {m.c, m.d, m.a - q * m.c, m.b - q * m.d};
+            int64_t t = xh - q * yh;
+            xh = yh;
+            yh = t;
+        }
+        return m.b != 0;
+    }
+
+    // r = p x + q y, known to be non-negative; p and q have opposite signs or one of them is 0
+    void combine(digits &r, digits const &x, int64_t p, digits const &y, int64_t q) {
+        digits const &pos = p > q ? x : y, &neg = p > q ? y : x;
+        auto mp = static_cast<uint32_t>(std::max(p, q)), mn = static_cast<uint32_t>(-std::min(p, q));
+        size_t n = x.size();
+        r.assign(n + 1, 0);
+        r[pos.size()] = limbs::mul_1(r.data(), pos.data(), pos.size(), mp);
+        uint32_t borrow = limbs::submul_1(r.data(), neg.data(), neg.size(), mn);
+        limbs::sub_1(r.data() + neg.size(), r.data() + neg.size(), n + 1 - neg.size(), borrow);
+        normalize(r);
+    }
+
+    // x = x mod y, returns the quotient; y is not zero
+    digits divide(digits &x, digits const &y) {
+        if (x.size() < y.size()) {
+            return digits();
+        }
+        digits q(x.size() - y.size() + 1), r(y.size());
+        limbs::divrem(q.data(), r.data(), x.data(), x.size(), y.data(), y.size());
+        normalize(q);
+        normalize(r);
+        x.swap(r);
+        return q;
+    }
+
+    uint64_t binary_gcd(uint64_t x, uint64_t y) {
+        if (x == 0 || y == 0) {
+            return x | y;
+        }
+        int shift = __builtin_ctzll(x | y);
+        x >>= __builtin_ctzll(x);
+        while (y) {
+            y >>= __builtin_ctzll(y);
+            if (x > y) {
+                std::swap(x, y);
+            }
+            y -= x;
+        }
+        return x << shift;
+    }
+
+    // Lehmer steps on x >= y until y fits into two digits. Each step reports either
+    // its cofactors or, when the leading bits decide nothing, the quotient of a full division.
+    template<typename OnCofactors, typename OnQuotient>
+    void lehmer_reduce(digits &x, digits &y, OnCofactors on_cofactors, OnQuotient on_quotient) {
+        digits nx, ny;
+        while (y.size() > 2) {
+            size_t shift = bit_length(x) - 62;
+            cofactors m;
+            if (lehmer_cofactors(static_cast<int64_t>(bits_at(x, shift)), static_cast<int64_t>(bits_at(y, shift)), m)) {
+                combine(nx, x, m.a, y, m.b);
+                combine(ny, x, m.c, y, m.d);
+                x.swap(nx);
+                y.swap(ny);
+                on_cofactors(m);
+            } else {
+                digits q = divide(x, y);
+                x.swap(y);
+                on_quotient(q);
+            }
+        }
+    }
+
+    digits to_digits(uint64_t v) {
+        digits res = {static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32)};
+        normalize(res);
+        return res;
+    }
+}
+
+big_integer gcd(big_integer const &a, big_integer const &b) {
+    digits x(a.value.data(), a.value.data() + a.value.size()), y(b.value.data(), b.value.data() + b.value.size());
+    normalize(x);
+    normalize(y);
+    if (x.size() < y.size() || (x.size() == y.size() && limbs::cmp_n(x.data(), y.data(), x.size()) < 0)) {
+        x.swap(y);
+    }
+    lehmer_reduce(x, y, [](cofactors const &) {}, [](digits const &) {});
+    if (!y.empty()) {
+        if (x.size() > 2) {
+            divide(x, y);
+        }
+        x = to_digits(binary_gcd(to_uint64(x), to_uint64(y)));
+    }
+    big_integer res;
+    if (!x.empty()) {
+        res.value.resize(x.size());
+        std::copy(x.begin(), x.end(), res.value.mutable_data());
+    }
+    return res;
+}
+
+big_integer lcm(big_integer const &a, big_integer const &b) {
+    if (a.is_zero() || b.is_zero()) {
+        return 0;
+    }
+    big_integer res = a / gcd(a, b) * b;
+    res.sign = 1;
+    return res;
+}
+
+big_integer extended_gcd(big_integer const &a, big_integer const &b, big_integer &x, big_integer &y) {
+    auto to_big = [](digits const &d) {
+        big_integer res;
+        if (!d.empty()) {
+            res.value.resize(d.size());
+            std::copy(d.begin(), d.end(), res.value.mutable_data());
+        }
+        return res;
+    };
+    auto from_int64 = [&to_big](int64_t v) {
+        big_integer res = to_big(to_digits(static_cast<uint64_t>(v < 0 ? -v : v)));
+        res.sign = v < 0 ? -1 : 1;
+        return res;
+    };
+    big_integer u = a, v = b;
+    u.sign = v.sign = 1;
+    bool swapped = u < v;
+    if (swapped) {
+        std::swap(u, v);
+    }
+    if (v.is_zero()) {
+        // gcd(u, 0) = u = 1 * u
+        x = swapped ? 0 : a.sign;
+        y = swapped ? b.sign : 0;
+        return u;
+    }
+    // s0 u = current x, s1 u = current y, modulo v
+    big_integer s0 = 1, s1 = 0;
+    digits dx(u.value.data(), u.value.data() + u.value.size()), dy(v.value.data(), v.value.data() + v.value.size());
+    auto quotient_step = [&](big_integer const &q) {
+        big_integer t = s0 - q * s1;
+        s0 = std::move(s1);
+        s1 = std::move(t);
+    };
+    lehmer_reduce(dx, dy, [&](cofactors const &m) {
+        big_integer t0 = s0 * from_int64(m.a) + s1 * from_int64(m.b);
+        s1 = s0 * from_int64(m.c) + s1 * from_int64(m.d);
+        s0 = std::move(t0);
+    }, [&](digits const &q) {
+        quotient_step(to_big(q));
+    });
+    if (!dy.empty() && dx.size() > 2) {
+        quotient_step(to_big(divide(dx, dy)));
+        dx.swap(dy);
+    }
+    if (!dy.empty()) {
+        // both fit into 64 bits now
+        uint64_t sx = to_uint64(dx), sy = to_uint64(dy);
+        while (sy) {
+            uint64_t q = sx / sy, t = sx - q * sy;
+            quotient_step(to_big(to_digits(q)));
+            sx = sy;
+            sy = t;
+        }
+        dx = to_digits(sx);
+    }
+    big_integer g = to_big(dx);
+    // u s0 + v t = g
+    big_integer t = (g - u * s0) / v;
+    x = swapped ? t : s0;
+    y = swapped ? s0 : t;
+    if (a.sign < 0) {
+        x = -x;
+    }
+    if (b.sign < 0) {
+        y = -y;
+    }
+    return g;
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <stdexcept>
+#include "big_integer_mod.h"
+#include "limb_ops.h"
+
+big_integer::modular_context::modular_context(big_integer const &m) : m(m), n(m.value.size()) {
+    if (m <= 1) {
+        throw std::runtime_error("Modulus must be greater than one");
+    }
+    uint32_t const *d = m.value.data();
+    montgomery = d[0] & 1;
+    m_inv = 0;
+    if (montgomery) {
+        // Newton's iteration doubles the correct low bits: 3, 6, 12, 24, 48
+        uint32_t inv = d[0];
+        for (int i = 0; i < 4; i++) {
+            inv *= 2 - d[0] * inv;
+        }
+        m_inv = -inv;
+        big_integer r = (big_integer(1) << static_cast<int>(64 * n)) % m;
+        r2.assign(n, 0);
+        std::copy(r.value.data(), r.value.data() + r.value.size(), r2.begin());
+    } else if (limbs::normalized_size(d, n - 1) != 0 || d[n - 1] != 1) {
+        // m > B^(n - 1), so mu = floor(B^(2n) / m) < B^(n + 1) fits into n + 1 digits
+        big_integer q = (big_integer(1) << static_cast<int>(64 * n)) / m;
+        mu.assign(n + 1, 0);
+        std::copy(q.value.data(), q.value.data() + q.value.size(), mu.begin());
+    }
+    m_digits.assign(n + 1, 0);
+    std::copy(d, d + n, m_digits.begin());
+    product.resize(2 * n + 2);
+    quotient.resize(4 * n + 4);
+    x.resize(n);
+    y.resize(n);
+    ws.resize(limbs::mul_n_scratch(n + 1));
+}
+
+big_integer const &big_integer::modular_context::modulus() const {
+    return m;
+}
+
+big_integer big_integer::modular_context::reduce(big_integer const &a) const {
+    if (a.sign > 0 && a < m) {
+        return a;
+    }
+    big_integer r = a % m;
+    if (r.sign < 0) {
+        r += m;
+    }
+    return r;
+}
+
+void big_integer::modular_context::load(uint32_t *r, big_integer const &a) const {
+    big_integer reduced = reduce(a);
+    std::fill(r, r + n, 0);
+    std::copy(reduced.value.data(), reduced.value.data() + reduced.value.size(), r);
+}
+
+big_integer big_integer::modular_context::store(uint32_t const *a) const {
+    big_integer res;
+    res.value.resize(n);
+    std::copy(a, a + n, res.value.mutable_data());
+    res.shrink_to_fit();
+    return res;
+}
+
+void big_integer::modular_context::mul_n(uint32_t *r, uint32_t const *a, uint32_t const *b) const {
+    uint32_t *t = product.data();
+    uint32_t const *md = m_digits.data();
+    limbs::mul_n(t, a, b, n, ws.data());
+    if (montgomery) {
+        // REDC: each step clears t[i] and keeps its carry there, to be added at t[i + n] at the end
+        for (size_t i = 0; i < n; i++) {
+            t[i] = limbs::addmul_1(t + i, md, n, t[i] * m_inv);
+        }
+        uint32_t carry = limbs::add_n(r, t + n, t, n);
+        if (carry || limbs::cmp_n(r, md, n) >= 0) {
+            limbs::sub_n(r, r, md, n);
+        }
+        return;
+    }
+    if (mu.empty()) {
+        // m = B^(n - 1): the low digits are the remainder
+        std::copy(t, t + n - 1, r);
+        r[n - 1] = 0;
+        return;
+    }
+    // Barrett: with t' = floor(t / B^(n - 1)), mu = B^(2n) / m - e0 and t' = t / B^(n - 1) - e1
+    // for 0 <= e0, e1 < 1, q = floor(t' * mu / B^(n + 1)) is above
+    // t / m - e0 t / B^(2n) - e1 B^(n - 1) / m - 1 > t / m - 3, as t < m^2 < B^(2n) and m >= B^(n - 1).
+    // So t - q * m < 3m, at most two subtractions; it is below B^(n + 1) and computed modulo that.
+    uint32_t *q = quotient.data(), *qm = q + 2 * n + 2;
+    t[2 * n] = 0;
+    limbs::mul_n(q, t + n - 1, mu.data(), n + 1, ws.data());
+    limbs::mul_n(qm, q + n + 1, md, n + 1, ws.data());
+    limbs::sub_n(t, t, qm, n + 1);
+    while (limbs::cmp_n(t, md, n + 1) >= 0) {
+        limbs::sub_n(t, t, md, n + 1);
+    }
+    std::copy(t, t + n, r);
+}
+
+big_integer big_integer::modular_context::mul_mod(big_integer const &a, big_integer const &b) const {
+    load(x.data(), a);
+    load(y.data(), b);
+    mul_n(x.data(), x.data(), y.data());
+    if (montgomery) {
+        mul_n(x.data(), x.data(), r2.data());
+    }
+    return store(x.data());
+}
+
+big_integer big_integer::modular_context::pow_mod(big_integer const &base, big_integer const &exponent) const {
+    if (exponent.sign < 0) {
+        return pow_mod(inverse_mod(base), -exponent);
+    }
+    load(x.data(), base);
+    if (montgomery) {
+        mul_n(x.data(), x.data(), r2.data());
+    }
+    pow_n(y.data(), x.data(), exponent.value.data(), exponent.value.size());
+    if (montgomery) {
+        std::fill(x.begin(), x.end(), 0);
+        x[0] = 1;
+        mul_n(y.data(), y.data(), x.data());
+    }
+    return store(y.data());
+}
+
+void big_integer::modular_context::pow_n(uint32_t *r, uint32_t const *a, uint32_t const *e, size_t digits) const {
+    digits = limbs::normalized_size(e, digits);
+    size_t bits = digits ? 32 * digits - static_cast<size_t>(__builtin_clz(e[digits - 1])) : 0;
+    auto bit = [e](size_t i) { return (e[i / 32] >> (i % 32)) & 1; };
+
+    // odd powers g, g^3, ..., g^(2^k - 1); the table only grows, so repeated powers allocate nothing
+    size_t k = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 6 ? 2 : 1;
+    if (table.size() < (n << (k - 1))) {
+        table.resize(n << (k - 1));
+    }
+    std::copy(a, a + n, table.begin());
+    // g^2 goes to r, it is free until the result starts
+    mul_n(r, table.data(), table.data());
+    for (size_t i = 1; i < (size_t(1) << (k - 1)); i++) {
+        mul_n(table.data() + i * n, table.data() + (i - 1) * n, r);
+    }
+
+    // 1 in the working form: R mod m for Montgomery
+    std::fill(r, r + n, 0);
+    r[0] = 1;
+    if (montgomery) {
+        mul_n(r, r, r2.data());
+    }
+    bool started = false;
+    for (size_t i = bits; i-- > 0;) {
+        if (!bit(i)) {
+            if (started) {
+                mul_n(r, r, r);
+            }
+            continue;
+        }
+        // the longest window [j, i] of at most k bits that ends with a set bit
+        size_t j = i + 1 >= k ? i + 1 - k : 0;
+        while (!bit(j)) {
+            j++;
+        }
+        size_t window = 0;
+        for (size_t b = i + 1; b-- > j;) {
+            window = 2 * window + bit(b);
+        }
+        uint32_t const *power = table.data() + (window / 2) * n;
+        if (started) {
+            for (size_t b = j; b <= i; b++) {
+                mul_n(r, r, r);
+            }
+            mul_n(r, r, power);
+        } else {
+            std::copy(power, power + n, r);
+            started = true;
+        }
+        i = j;
+    }
+}
+
+big_integer big_integer::modular_context::inverse_mod(big_integer const &a) const {
+    // extended Euclid keeping only the coefficient of a
+    big_integer r0 = m, r1 = reduce(a), t0 = 0, t1 = 1;
+    while (!r1.is_zero()) {
+        auto qr = divmod(r0, r1);
+        r0 = std::move(r1);
+        r1 = std::move(qr.second);
+        big_integer t = t0 - qr.first * t1;
+        t0 = std::move(t1);
+        t1 = std::move(t);
+    }
+    if (r0 != 1) {
+        throw std::runtime_error("Number is not invertible modulo m");
+    }
+    return reduce(t0);
+}
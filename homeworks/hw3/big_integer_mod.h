@@ -0,0 +1,62 @@
+#ifndef BIGINT_HW3_BIG_INTEGER_MOD_H
+#define BIGINT_HW3_BIG_INTEGER_MOD_H
+
+#include <vector>
+#include "big_integer.h"
+
+// Arithmetic modulo a fixed m > 1. Residues are kept as arrays of n digits, n digits of m:
+// in Montgomery form x * 2^(32n) mod m for odd m, reduced by Barrett's method for even m.
+// Scratch buffers belong to the context, so one context must not be used by two threads at once.
+struct big_integer::modular_context {
+    explicit modular_context(big_integer const &m);
+
+    big_integer const &modulus() const;
+
+    // a mod m in [0, m), negative a included
+    big_integer reduce(big_integer const &a) const;
+
+    big_integer mul_mod(big_integer const &a, big_integer const &b) const;
+
+    // base^exponent mod m by a sliding window, a negative exponent inverts the base
+    big_integer pow_mod(big_integer const &base, big_integer const &exponent) const;
+
+    // x in [0, m) with a * x = 1 (mod m), throws if gcd(a, m) != 1
+    big_integer inverse_mod(big_integer const &a) const;
+
+private:
+    big_integer m;
+    size_t n;
+    bool montgomery;
+    // -m^-1 mod 2^32 for Montgomery
+    uint32_t m_inv;
+    // R^2 mod m, R = 2^(32n) for Montgomery; floor(2^(64n) / m) of n + 1 digits for Barrett,
+    // empty when m = 2^(32(n - 1)) and the reduction takes the low digits
+    std::vector<uint32_t> r2, mu;
+    // m padded to n + 1 digits
+    std::vector<uint32_t> m_digits;
+    // product of 2n + 2 digits, Barrett quotient and its product by m, operands, mul_n workspace,
+    // odd powers of pow_n, buffers of the primality tests; the last two grow on first use
+    mutable std::vector<uint32_t> product, quotient, x, y, ws, table, scratch;
+
+    // r[0..n) = reduced a, not converted to Montgomery form
+    void load(uint32_t *r, big_integer const &a) const;
+
+    big_integer store(uint32_t const *a) const;
+
+    // r = a * b in the working form (a * b / R for Montgomery), r may be a or b
+    void mul_n(uint32_t *r, uint32_t const *a, uint32_t const *b) const;
+
+    // r = a^e for e[0..digits) in the working form, r may be a
+    void pow_n(uint32_t *r, uint32_t const *a, uint32_t const *e, size_t digits) const;
+
+    friend struct big_integer;
+
+    // Rounds of big_integer::is_probable_prime for odd m. Nothing is allocated once
+    // the buffers have grown. Strong probable prime to base[0..n), 1 < base < m - 1:
+    bool miller_rabin(uint32_t const *base) const;
+
+    // strong Lucas probable prime with P = 1, Q = (1 - d) / 4, the Jacobi symbol (d / m) is -1
+    bool strong_lucas(int32_t d) const;
+};
+
+#endif //BIGINT_HW3_BIG_INTEGER_MOD_H
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+#include "big_integer.h"
+#include "big_integer_mod.h"
+#include "limb_ops.h"
+
+namespace {
+    // primes below 1000 for trial division, by the sieve of Eratosthenes
+    std::vector<uint32_t> const &small_primes() {
+        static std::vector<uint32_t> const primes = [] {
+            std::vector<uint32_t> res;
+            std::vector<bool> composite(1000);
+            for (uint32_t p = 2; p < 1000; p++) {
+                if (!composite[p]) {
+                    res.push_back(p);
+                    for (uint32_t q = p * p; q < 1000; q += p) {
+                        composite[q] = true;
+                    }
+                }
+            }
+            return res;
+        }();
+        return primes;
+    }
+
+    uint32_t mod_1(uint32_t const *a, size_t n, uint32_t p) {
+        uint64_t r = 0;
+        for (size_t i = n; i-- > 0;) {
+            r = ((r << 32) | a[i]) % p;
+        }
+        return static_cast<uint32_t>(r);
+    }
+
+    // Jacobi symbol (a / n) for odd n > 0
+    int jacobi(uint64_t a, uint64_t n) {
+        a %= n;
+        int res = 1;
+        while (a) {
+            while (a % 2 == 0) {
+                a /= 2;
+                if (n % 8 == 3 || n % 8 == 5) {
+                    res = -res;
+                }
+            }
+            std::swap(a, n);
+            if (a % 4 == 3 && n % 4 == 3) {
+                res = -res;
+            }
+            a %= n;
+        }
+        return n == 1 ? res : 0;
+    }
+
+    // (d / m) for odd d and odd m[0..n) by reciprocity: (-1 / m) = (-1)^((m - 1) / 2)
+    // and (a / m) = (m / a) unless both are 3 mod 4
+    int jacobi(int64_t d, uint32_t const *m, size_t n) {
+        uint32_t a = static_cast<uint32_t>(d < 0 ? -d : d), m4 = m[0] % 4;
+        int res = d < 0 && m4 == 3 ? -1 : 1;
+        if (a % 4 == 3 && m4 == 3) {
+            res = -res;
+        }
+        return res * jacobi(mod_1(m, n, a), a);
+    }
+
+    // a[0..n) >> s for the largest s leaving it odd, a is not zero; returns s
+    size_t strip_twos(uint32_t *a, size_t n) {
+        size_t zeros = 0;
+        while (a[zeros] == 0) {
+            zeros++;
+        }
+        std::copy(a + zeros, a + n, a);
+        std::fill(a + n - zeros, a + n, 0);
+        auto bits = static_cast<unsigned>(__builtin_ctz(a[0]));
+        if (bits) {
+            limbs::rshift(a, a, n - zeros, bits);
+        }
+        return 32 * zeros + bits;
+    }
+
+    // Residues modulo m of n digits, in [0, m)
+    void add_mod(uint32_t *r, uint32_t const *a, uint32_t const *b, uint32_t const *m, size_t n) {
+        if (limbs::add_n(r, a, b, n) || limbs::cmp_n(r, m, n) >= 0) {
+            limbs::sub_n(r, r, m, n);
+        }
+    }
+
+    void sub_mod(uint32_t *r, uint32_t const *a, uint32_t const *b, uint32_t const *m, size_t n) {
+        if (limbs::sub_n(r, a, b, n)) {
+            limbs::add_n(r, r, m, n);
+        }
+    }
+
+    // a / 2 for odd m: (a + m) / 2 for odd a
+    void half_mod(uint32_t *r, uint32_t const *a, uint32_t const *m, size_t n) {
+        uint32_t carry = 0;
+        if (a[0] & 1) {
+            carry = limbs::add_n(r, a, m, n);
+            a = r;
+        }
+        limbs::rshift(r, a, n, 1);
+        r[n - 1] |= carry << 31;
+    }
+
+    bool is_zero_n(uint32_t const *a, size_t n) {
+        return std::all_of(a, a + n, [](uint32_t x) { return x == 0; });
+    }
+}
+
+bool big_integer::modular_context::miller_rabin(uint32_t const *base) const {
+    // m - 1 = e * 2^s with odd e
+    if (scratch.size() < 4 * n) {
+        scratch.resize(4 * n);
+    }
+    uint32_t *e = scratch.data(), *one = e + n, *minus_one = one + n, *t = minus_one + n;
+    limbs::sub_1(e, m_digits.data(), n, 1);
+    size_t s = strip_twos(e, n);
+    std::fill(one, one + n, 0);
+    one[0] = 1;
+    mul_n(one, one, r2.data());
+    limbs::sub_n(minus_one, m_digits.data(), one, n);
+
+    mul_n(t, base, r2.data());
+    pow_n(t, t, e, n);
+    if (limbs::cmp_n(t, one, n) == 0 || limbs::cmp_n(t, minus_one, n) == 0) {
+        return true;
+    }
+    for (size_t i = 1; i < s; i++) {
+        mul_n(t, t, t);
+        if (limbs::cmp_n(t, minus_one, n) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool big_integer::modular_context::strong_lucas(int32_t d) const {
+    if (scratch.size() < 8 * n + 1) {
+        scratch.resize(8 * n + 1);
+    }
+    // m + 1 = e * 2^s with odd e, of n + 1 digits
+    uint32_t *e = scratch.data(), *u = e + n + 1, *v = u + n, *qk = v + n, *dw = qk + n, *qw = dw + n,
+            *t = qw + n;
+    uint32_t const *md = m_digits.data();
+    e[n] = limbs::add_1(e, md, n, 1);
+    size_t s = strip_twos(e, n + 1);
+    size_t digits = limbs::normalized_size(e, n + 1);
+    size_t bits = 32 * digits - static_cast<size_t>(__builtin_clz(e[digits - 1]));
+
+    // small signed constants c in the working form
+    auto constant = [this, md](uint32_t *r, int64_t c) {
+        std::fill(r, r + n, 0);
+        r[0] = static_cast<uint32_t>(c < 0 ? -c : c);
+        mul_n(r, r, r2.data());
+        if (c < 0 && !is_zero_n(r, n)) {
+            limbs::sub_n(r, md, r, n);
+        }
+    };
+    constant(dw, d);
+    constant(qw, (1 - int64_t(d)) / 4);
+    // U_1 = 1, V_1 = P = 1, Q^1
+    constant(u, 1);
+    std::copy(u, u + n, v);
+    std::copy(qw, qw + n, qk);
+    for (size_t i = bits - 1; i-- > 0;) {
+        // U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+        mul_n(u, u, v);
+        mul_n(v, v, v);
+        add_mod(t, qk, qk, md, n);
+        sub_mod(v, v, t, md, n);
+        mul_n(qk, qk, qk);
+        if ((e[i / 32] >> (i % 32)) & 1) {
+            // U_k+1 = (U_k + V_k) / 2, V_k+1 = (D U_k + V_k) / 2
+            mul_n(t, dw, u);
+            add_mod(u, u, v, md, n);
+            half_mod(u, u, md, n);
+            add_mod(v, v, t, md, n);
+            half_mod(v, v, md, n);
+            mul_n(qk, qk, qw);
+        }
+    }
+    if (is_zero_n(u, n)) {
+        return true;
+    }
+    // V_(e 2^r) for r < s
+    for (size_t r = 0; r < s; r++) {
+        if (is_zero_n(v, n)) {
+            return true;
+        }
+        mul_n(v, v, v);
+        add_mod(t, qk, qk, md, n);
+        sub_mod(v, v, t, md, n);
+        mul_n(qk, qk, qk);
+    }
+    return false;
+}
+
+bool big_integer::is_probable_prime(unsigned rounds) const {
+    if (sign < 0) {
+        return false;
+    }
+    uint32_t const *d = value.data();
+    size_t n = value.size();
+    for (uint32_t p : small_primes()) {
+        if (n == 1 && d[0] == p) {
+            return true;
+        }
+        if (mod_1(d, n, p) == 0) {
+            return false;
+        }
+    }
+    if (n == 1 && d[0] < 1000 * 1000) {
+        // 0, 1, or without factors below its square root
+        return d[0] > 1;
+    }
+    modular_context ctx(*this);
+    std::vector<uint32_t> base(n, 0);
+    base[0] = 2;
+    if (!ctx.miller_rabin(base.data())) {
+        return false;
+    }
+    // Selfridge's d: the first of 5, -7, 9, -11, ... with (d / m) = -1; there is none for squares,
+    // so they are looked for if it takes long
+    int32_t lucas_d = 5;
+    for (int tries = 0;; tries++) {
+        int j = jacobi(lucas_d, d, n);
+        if (j == -1) {
+            break;
+        }
+        // (d / m) = 0: m has a factor in common with the smaller |d|
+        if (j == 0 || (tries == 10 && isqrt().pow(2) == *this)) {
+            return false;
+        }
+        lucas_d = lucas_d > 0 ? -lucas_d - 2 : -lucas_d + 2;
+    }
+    if (!ctx.strong_lucas(lucas_d)) {
+        return false;
+    }
+    // further rounds to random bases 1 < base < m - 1: shorter than m, not 0 or 1
+    std::mt19937 rng(static_cast<uint32_t>(d[0]));
+    for (unsigned r = 0; r < rounds; r++) {
+        if (n == 1) {
+            base[0] = 2 + rng() % (d[0] - 3);
+        } else {
+            std::generate(base.begin(), base.end() - 1, std::ref(rng));
+            base[0] = limbs::normalized_size(base.data(), n) > 1 ? base[0] : std::max<uint32_t>(base[0], 2);
+        }
+        if (!ctx.miller_rabin(base.data())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+big_integer big_integer::next_prime() const {
+    if (*this < 2) {
+        return 2;
+    }
+    // odd candidates after this, the ones with a small factor skipped by their residues
+    big_integer c = *this + 1 + (value[0] % 2);
+    std::vector<uint32_t> const &primes = small_primes();
+    std::vector<uint32_t> residues(primes.size());
+    for (size_t i = 0; i < primes.size(); i++) {
+        residues[i] = mod_1(c.value.data(), c.value.size(), primes[i]);
+    }
+    while (true) {
+        bool small_factor = false;
+        for (size_t i = 1; i < primes.size() && !small_factor; i++) {
+            small_factor = residues[i] == 0 && c != primes[i];
+        }
+        if (!small_factor && c.is_probable_prime()) {
+            return c;
+        }
+        c += 2;
+        for (size_t i = 0; i < primes.size(); i++) {
+            residues[i] = (residues[i] + 2) % primes[i];
+        }
+    }
+}
@@ -3,9 +3,19 @@
 #include <cstdlib>
 #include <vector>
 #include <utility>
+#include <sstream>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
+#include "basic_big_integer.h"
+#include "big_integer_expr.h"
+#include "big_integer_mod.h"
+#include "big_integer_view.h"
+#include "fixed_integer.h"
+#include "limb_alloc.h"
+#include "limb_ops.h"
+#include "uintvector.h"
 
 TEST(correctness, two_plus_two) {
     EXPECT_EQ(big_integer(2) + big_integer(2), big_integer(4));
@@ -661,3 +671,1035 @@ TEST(correctness, div_randomized) {
         EXPECT_LT(residue, divisor);
     }
 }
+
+namespace {
+    template<typename F>
+    auto with_schoolbook_only(F f) {
+        size_t karatsuba = limbs::karatsuba_threshold;
+        limbs::karatsuba_threshold = SIZE_MAX;
+        auto res = f();
+        limbs::karatsuba_threshold = karatsuba;
+        return res;
+    }
+}
+
+TEST(correctness, mul_karatsuba_toom3) {
+    size_t const sizes[] = {1, 50, 51, 52, 100, 200, 201, 202, 400, 700};
+    for (size_t an : sizes) {
+        for (size_t bn : sizes) {
+            big_integer a = rand_big(an);
+            big_integer b = (bn % 2 == 0) ? -rand_big(bn) : rand_big(bn);
+            big_integer expected = with_schoolbook_only([&] { return a * b; });
+            EXPECT_EQ(a * b, expected);
+            EXPECT_EQ(b * a, expected);
+        }
+    }
+}
+
+TEST(correctness, mul_karatsuba_toom3_sparse) {
+    // long runs of zero and full digits stress carry handling of the interpolation
+    big_integer a = (big_integer(1) << 20003) - 1;
+    big_integer b = (big_integer(1) << 15001) + 1;
+    big_integer expected = with_schoolbook_only([&] { return a * b; });
+    EXPECT_EQ(a * b, expected);
+    EXPECT_EQ(a * a, (big_integer(1) << 40006) - (big_integer(1) << 20004) + 1);
+    EXPECT_EQ(a * 0, 0);
+}
+
+TEST(correctness, mul_ntt) {
+    size_t const sizes[] = {1, 2, 3, 17, 64, 300, 1000};
+    for (size_t an : sizes) {
+        for (size_t bn : sizes) {
+            big_integer a = rand_big(an);
+            big_integer b = (an % 2 == 0) ? -rand_big(bn) : rand_big(bn);
+            EXPECT_EQ(big_integer::mul_ntt(a, b), a * b);
+        }
+    }
+    EXPECT_EQ(big_integer::mul_ntt(rand_big(100), 0), 0);
+    EXPECT_EQ(big_integer::mul_ntt(-1, 1), -1);
+}
+
+TEST(correctness, mul_ntt_max_coefficients) {
+    // all digits equal to 2^32 - 1 give the largest convolution coefficients
+    big_integer a = (big_integer(1) << 96001) - 1;
+    big_integer b = (big_integer(1) << 64001) - 1;
+    EXPECT_EQ(big_integer::mul_ntt(a, b), with_schoolbook_only([&] { return a * b; }));
+    EXPECT_EQ(a * b, (big_integer(1) << 160002) - (big_integer(1) << 96001) - (big_integer(1) << 64001) + 1);
+}
+
+TEST(correctness, mul_parallel_matches_sequential) {
+    size_t const sizes[] = {40, 300, 700, 3500};
+    std::vector<big_integer> values, expected;
+    for (size_t n : sizes) {
+        values.push_back(rand_big(n));
+    }
+    values.push_back(-((big_integer(1) << 96001) - 1));
+    for (auto const &a : values) {
+        for (auto const &b : values) {
+            expected.push_back(a * b);
+        }
+        expected.push_back(big_integer::mul_ntt(a, values[2]));
+    }
+    // tasks down to tiny products, more threads than cores
+    big_integer::set_multiplication_threads(4, 16);
+    size_t i = 0;
+    for (auto const &a : values) {
+        for (auto const &b : values) {
+            EXPECT_EQ(a * b, expected[i++]);
+        }
+        EXPECT_EQ(big_integer::mul_ntt(a, values[2]), expected[i++]);
+    }
+    big_integer::set_multiplication_threads(1);
+}
+
+TEST(correctness, string_conv_long) {
+    std::string nines(5000, '9');
+    big_integer ten_pow = 1;
+    for (int i = 0; i < 5000; i++) {
+        ten_pow *= 10;
+    }
+    EXPECT_EQ(big_integer(nines), ten_pow - 1);
+    EXPECT_EQ(to_string(ten_pow - 1), nines);
+    EXPECT_EQ(to_string(ten_pow), "1" + std::string(5000, '0'));
+    EXPECT_EQ(to_string(-ten_pow - 7), "-1" + std::string(4999, '0') + "7");
+    EXPECT_EQ(big_integer("-000" + nines), 1 - ten_pow);
+}
+
+TEST(correctness, string_conv_randomized) {
+    for (size_t len : {1, 8, 9, 10, 17, 361, 362, 1000, 4000, 12345}) {
+        std::string str(len, '0');
+        for (auto &c : str) {
+            c = static_cast<char>('0' + rand() % 10);
+        }
+        str[0] = static_cast<char>('1' + rand() % 9);
+        big_integer a(str);
+        EXPECT_EQ(to_string(a), str);
+        EXPECT_EQ(to_string(-a), "-" + str);
+        EXPECT_EQ(big_integer(str + "0"), a * 10);
+    }
+}
+
+TEST(correctness, string_conv_invalid) {
+    EXPECT_THROW(big_integer(""), std::runtime_error);
+    EXPECT_THROW(big_integer("-"), std::runtime_error);
+    EXPECT_THROW(big_integer("12a3"), std::runtime_error);
+    EXPECT_EQ(big_integer("+42"), 42);
+}
+
+namespace {
+    void check_divmod(big_integer const &a, big_integer const &b) {
+        auto qr = divmod(a, b);
+        ASSERT_EQ(qr.first * b + qr.second, a);
+        big_integer abs_b = b < 0 ? -b : b;
+        ASSERT_TRUE(-abs_b < qr.second && qr.second < abs_b);
+        ASSERT_TRUE(qr.second == 0 || (qr.second < 0) == (a < 0));
+        ASSERT_EQ(qr.first, a / b);
+        ASSERT_EQ(qr.second, a % b);
+    }
+}
+
+TEST(correctness, divmod_burnikel_ziegler) {
+    size_t const sizes[] = {1, 2, 30, 63, 64, 65, 100, 150, 300, 600};
+    for (size_t bn : sizes) {
+        for (size_t qn : sizes) {
+            big_integer b = rand_big(bn);
+            big_integer a = b * rand_big(qn) + rand_big(bn / 2);
+            check_divmod(a, b);
+            check_divmod(-a, b);
+            check_divmod(a, -b);
+        }
+    }
+}
+
+TEST(correctness, divmod_corrections) {
+    // divisors and dividends of all one bits force quotient corrections
+    for (int bits : {1601, 3201, 6401}) {
+        big_integer b = (big_integer(1) << bits) - 1;
+        check_divmod((big_integer(1) << (3 * bits + 5)) - 1, b);
+        check_divmod(b * b, b);
+        check_divmod(b * b - 1, b);
+        check_divmod(b * (b + 1) + b - 1, b + 1);
+    }
+    EXPECT_THROW(divmod(1, 0), std::runtime_error);
+}
+
+TEST(correctness, compound_in_place) {
+    big_integer a = rand_big(40), b = rand_big(25);
+    big_integer c = a;
+    c += b;
+    EXPECT_EQ(c, a + b);
+    EXPECT_EQ(c - b, a);
+    c -= a + b;
+    EXPECT_EQ(c, 0);
+    c = a;
+    c += c;
+    EXPECT_EQ(c, a * 2);
+    c -= c;
+    EXPECT_EQ(c, 0);
+    EXPECT_FALSE(c < 0);
+
+    c = b;
+    c -= a;
+    EXPECT_EQ(c, -(a - b));
+    c += a;
+    EXPECT_EQ(c, b);
+    c <<= 37;
+    EXPECT_EQ(c, b * (big_integer(1) << 37));
+    c <<= 64;
+    EXPECT_EQ(c >> 101, b);
+    // copies share storage until written
+    EXPECT_EQ(a + 0, a);
+    EXPECT_EQ(std::move(c) + b, (b << 101) + b);
+}
+
+TEST(correctness, increment_carry) {
+    big_integer a("4294967295");
+    ++a;
+    EXPECT_EQ(a, big_integer("4294967296"));
+    --a;
+    EXPECT_EQ(a, big_integer("4294967295"));
+    big_integer b("-18446744073709551616");
+    EXPECT_EQ(b++, big_integer("-18446744073709551616"));
+    EXPECT_EQ(b, big_integer("-18446744073709551615"));
+    b--;
+    EXPECT_EQ(b, big_integer("-18446744073709551616"));
+
+    big_integer z = 0;
+    EXPECT_EQ(--z, -1);
+    EXPECT_EQ(++z, 0);
+    EXPECT_FALSE(z < 0);
+    EXPECT_EQ(++z, 1);
+}
+
+TEST(correctness, move_semantics) {
+    big_integer a = rand_big(20);
+    big_integer copy = a;
+    big_integer b(std::move(a));
+    EXPECT_EQ(b, copy);
+    EXPECT_EQ(a, 0);
+    a = std::move(b);
+    EXPECT_EQ(a, copy);
+    a = std::move(a);
+    EXPECT_EQ(a, copy);
+    big_integer small = 5;
+    small = std::move(a);
+    EXPECT_EQ(small, copy);
+    a = big_integer(7);
+    EXPECT_EQ(a, 7);
+}
+
+TEST(correctness, expression_templates) {
+    for (int itn = 0; itn < 50; itn++) {
+        big_integer a = rand_big(1 + itn % 7), b = -rand_big(3), c = rand_big(itn % 3 + 1) - rand_big(2);
+        int sh = itn * 7 % 97 + 1;
+        EXPECT_EQ(big_integer(lazy(a) + b - c), a + b - c);
+        EXPECT_EQ(big_integer(lazy(a) * b + c * lazy(a) - b), a * b + c * a - b);
+        EXPECT_EQ(big_integer(-(lazy(b) << sh) + (lazy(a) >> sh)), -(b << sh) + (a >> sh));
+        EXPECT_EQ(big_integer(lazy(b) >> sh), b >> sh);
+        EXPECT_EQ(big_integer((lazy(a) & b) | (lazy(c) ^ a)), (a & b) | (c ^ a));
+        EXPECT_EQ(big_integer(lazy(c) - c), 0);
+        EXPECT_EQ(big_integer(lazy(a) << -sh), a >> sh);
+    }
+    // operands spanning several blocks of the evaluator
+    big_integer a = rand_big(900), b = -rand_big(700), c = (big_integer(1) << 20000) - 1;
+    EXPECT_EQ(big_integer(lazy(a) - b + c), a - b + c);
+    EXPECT_EQ(big_integer(lazy(b) - a - c), b - a - c);
+    EXPECT_EQ(big_integer((lazy(b) >> 8001) ^ (lazy(a) << 9001)), (b >> 8001) ^ (a << 9001));
+    EXPECT_EQ(big_integer(lazy(-1) >> 200), -1);
+    EXPECT_EQ(big_integer(lazy(big_integer("-4294967296")) + 0), big_integer("-4294967296"));
+    EXPECT_EQ(big_integer(lazy(5) - 5 + 2 - 7), -5);
+}
+
+TEST(correctness, bitwise_mixed_signs) {
+    big_integer const low_zeros = big_integer(1) << 100;
+    for (int itn = 0; itn < 40; itn++) {
+        big_integer a = rand_big(itn % 9 + 1), b = rand_big(itn % 5 + 2);
+        if (itn % 3 == 0) {
+            a = a * low_zeros;  // carries of ~x + 1 run through whole digits
+        }
+        if (itn % 2) {
+            a = -a;
+        }
+        if (itn % 4 > 1) {
+            b = -b;
+        }
+        EXPECT_EQ(a ^ b, (a | b) - (a & b));
+        EXPECT_EQ(a + b, (a ^ b) + 2 * (a & b));
+        EXPECT_EQ(-(a | b) - 1, (-a - 1) & (-b - 1));
+        EXPECT_EQ(a & -1, a);
+        EXPECT_EQ(a | 0, a);
+        EXPECT_EQ(a ^ a, 0);
+    }
+    EXPECT_EQ(big_integer("-4294967296") & big_integer("-18446744073709551616"), big_integer("-18446744073709551616"));
+    EXPECT_EQ(big_integer("-4294967296") | big_integer("-18446744073709551616"), big_integer("-4294967296"));
+}
+
+TEST(correctness, shift_whole_digits) {
+    big_integer a = rand_big(12);
+    EXPECT_EQ(a << 64, a * big_integer("18446744073709551616"));
+    EXPECT_EQ((a << 96) >> 96, a);
+    EXPECT_EQ(big_integer(1) << 32, big_integer("4294967296"));
+    EXPECT_EQ(big_integer("-4294967296") >> 32, -1);
+    EXPECT_EQ(big_integer("-4294967297") >> 32, -2);
+    EXPECT_EQ(-a >> 10000, -1);
+    EXPECT_EQ(a >> 10000, 0);
+    EXPECT_EQ(a << -64, a >> 64);
+}
+
+TEST(correctness, shift_floor_randomized) {
+    for (int itn = 0; itn < 100; itn++) {
+        big_integer a = rand_big(itn % 11 + 1);
+        if (itn % 2) {
+            a = -a;
+        }
+        int sh = itn * 13 % 300;
+        big_integer p = big_integer(1) << sh;
+        big_integer q = a / p;
+        if (a < 0 && q * p != a) {
+            q -= 1;  // floor instead of truncation
+        }
+        EXPECT_EQ(a >> sh, q);
+        EXPECT_EQ(a << sh, a * p);
+
+        big_integer b = a;
+        b >>= sh;
+        EXPECT_EQ(b, q);
+        b = a;
+        b <<= sh;
+        EXPECT_EQ(b, a * p);
+        b >>= sh;
+        EXPECT_EQ(b, a);
+    }
+}
+
+namespace {
+    template<typename Limb>
+    void check_basic_big_integer(big_integer const &a, big_integer const &b) {
+        typedef basic_big_integer<Limb> num;
+        num x(a), y(b);
+        ASSERT_EQ(big_integer(x), a);
+        EXPECT_EQ(big_integer(x + y), a + b);
+        EXPECT_EQ(big_integer(x - y), a - b);
+        EXPECT_EQ(big_integer(x * y), a * b);
+        if (b != 0) {
+            EXPECT_EQ(big_integer(x / y), a / b);
+            EXPECT_EQ(big_integer(x % y), a % b);
+        }
+        EXPECT_EQ(x < y, a < b);
+        EXPECT_EQ(x == y, a == b);
+    }
+}
+
+TEST(correctness, basic_big_integer_limbs) {
+    size_t const sizes[] = {0, 1, 2, 3, 7, 30, 60, 120};
+    for (size_t an : sizes) {
+        for (size_t bn : sizes) {
+            big_integer a = rand_big(an), b = rand_big(bn);
+            if (an % 2) {
+                a = -a;
+            }
+            if (bn % 3 == 1) {
+                b = -b;
+            }
+            check_basic_big_integer<uint32_t>(a, b);
+            check_basic_big_integer<uint64_t>(a, b);
+            check_basic_big_integer<uint64_t>(a * b + 1, b);
+        }
+    }
+    EXPECT_EQ(to_string(basic_big_integer<uint64_t>(-1234567890123456789ll) * 10), "-12345678901234567890");
+    EXPECT_EQ(to_string(basic_big_integer<uint64_t>("-18446744073709551616") / -65536), "281474976710656");
+    EXPECT_EQ(basic_big_integer<uint64_t>(0), -basic_big_integer<uint64_t>(0));
+    EXPECT_THROW(basic_big_integer<uint32_t>(1) / 0, std::runtime_error);
+}
+
+TEST(correctness, limb_kernels_edges) {
+    // odd and even lengths, all ones digits to force every carry
+    for (size_t n = 0; n < 10; n++) {
+        for (uint32_t fill : {0u, 1u, 0x80000000u, UINT32_MAX}) {
+            std::vector<uint32_t> a(n + 1, fill), b(n + 1, UINT32_MAX), r(n + 1), s(n + 1);
+            for (size_t i = 0; i < n; i++) {
+                a[i] ^= static_cast<uint32_t>(i * 0x9e3779b9u) & (fill >> 1);
+            }
+            uint32_t carry = limbs::add_n(r.data(), a.data(), b.data(), n);
+            uint32_t borrow = limbs::sub_n(s.data(), r.data(), b.data(), n);
+            EXPECT_EQ(carry, borrow);
+            EXPECT_TRUE(std::equal(a.begin(), a.begin() + n, s.begin()));
+
+            for (uint32_t x : {0u, 3u, UINT32_MAX}) {
+                std::vector<uint32_t> m(n + 1), acc(b);
+                m[n] = limbs::mul_1(m.data(), a.data(), n, x);
+                uint64_t c = 0;
+                for (size_t i = 0; i < n; i++) {
+                    c += uint64_t(a[i]) * x;
+                    EXPECT_EQ(m[i], static_cast<uint32_t>(c));
+                    c >>= 32;
+                }
+                EXPECT_EQ(m[n], static_cast<uint32_t>(c));
+                uint32_t hi = limbs::addmul_1(acc.data(), a.data(), n, x);
+                uint32_t lo = limbs::submul_1(acc.data(), a.data(), n, x);
+                EXPECT_EQ(hi, lo);
+                EXPECT_TRUE(std::equal(b.begin(), b.begin() + n, acc.begin()));
+            }
+        }
+    }
+}
+
+TEST(correctness, compare_three_way) {
+    big_integer a("123456789012345678901234567890123456789012345678901234567890");
+    big_integer b = a + 1;
+    EXPECT_EQ(compare(a, b), -1);
+    EXPECT_EQ(compare(b, a), 1);
+    EXPECT_EQ(compare(a, b - 1), 0);
+    EXPECT_EQ(compare(-a, -b), 1);
+    EXPECT_EQ(compare(-b, a), -1);
+    EXPECT_EQ(compare(big_integer(0), -big_integer(0)), 0);
+    EXPECT_EQ(compare(big_integer(0), -a), 1);
+    EXPECT_EQ(compare(a << 1000, b << 1000), -1);
+    EXPECT_TRUE(-b < -a);
+    EXPECT_TRUE(-a <= -a);
+    EXPECT_FALSE(-a > -a);
+    EXPECT_TRUE(-(a << 1000) >= -(b << 1000));
+}
+
+TEST(correctness, bitwise_kernels_masks) {
+    // lengths around the vector widths, every complement combination
+    for (size_t n = 0; n < 40; n++) {
+        std::vector<uint32_t> a(n), b(n), r(n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = static_cast<uint32_t>(i * 0x9e3779b9u);
+            b[i] = static_cast<uint32_t>(i * 0x85ebca6bu + 7);
+        }
+        for (uint32_t ma : {0u, UINT32_MAX}) {
+            for (uint32_t mb : {0u, UINT32_MAX}) {
+                for (uint32_t mr : {0u, UINT32_MAX}) {
+                    limbs::and_n(r.data(), a.data(), b.data(), n, ma, mb, mr);
+                    for (size_t i = 0; i < n; i++) {
+                        EXPECT_EQ(r[i], ((a[i] ^ ma) & (b[i] ^ mb)) ^ mr);
+                    }
+                    limbs::or_n(r.data(), a.data(), b.data(), n, ma, mb, mr);
+                    for (size_t i = 0; i < n; i++) {
+                        EXPECT_EQ(r[i], ((a[i] ^ ma) | (b[i] ^ mb)) ^ mr);
+                    }
+                    limbs::xor_n(r.data(), a.data(), b.data(), n, ma, mb, mr);
+                    for (size_t i = 0; i < n; i++) {
+                        EXPECT_EQ(r[i], (a[i] ^ ma ^ b[i] ^ mb) ^ mr);
+                    }
+                }
+            }
+        }
+        // the highest differing digit decides, wherever it falls in a vector
+        std::vector<uint32_t> c(a);
+        EXPECT_EQ(limbs::cmp_n(a.data(), c.data(), n), 0);
+        for (size_t i = 0; i < n; i++) {
+            c[i]++;
+            EXPECT_EQ(limbs::cmp_n(a.data(), c.data(), n), c[i] == 0 ? 1 : -1);
+            c[i]--;
+        }
+    }
+}
+
+TEST(correctness, arena_and_pool_storage) {
+    big_integer a = big_integer(1) << 1000, b = a - 1, escaped;
+    {
+        limb_alloc::arena outer;
+        big_integer c = a * b;
+        {
+            limb_alloc::arena inner;
+            escaped = c + a;
+            EXPECT_GT(inner.used(), 0u);
+        }
+        // the inner arena is closed, the outer one is active again
+        size_t used = outer.used();
+        c *= a;
+        EXPECT_GT(outer.used(), used);
+        EXPECT_EQ(c, a * a * b);
+    }
+    // outlived both arenas, still owns its chunk
+    EXPECT_EQ(escaped, a * a);
+    EXPECT_EQ(escaped - a * b, a);
+
+    // pool blocks freed on another thread
+    big_integer shared = a * a;
+    std::thread worker([&] {
+        big_integer local = shared;
+        local += 1;
+        shared = local - 1;
+    });
+    worker.join();
+    EXPECT_EQ(shared, a * a);
+}
+
+TEST(correctness, uintvector_capacity) {
+    uintvector v;
+    for (uint32_t i = 0; i < 100; i++) {
+        v.push_back(i);
+    }
+    EXPECT_GE(v.capacity(), 100u);
+    uintvector shared = v;
+    v.modify(0, 7);
+    EXPECT_EQ(shared[0], 0u);
+    EXPECT_EQ(v[99], 99u);
+
+    // growth keeps digits, shrinking gives the buffer back
+    v.reserve(1000);
+    EXPECT_GE(v.capacity(), 1000u);
+    EXPECT_EQ(v[99], 99u);
+    v.resize(50);
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 50u);
+    EXPECT_EQ(v[49], 49u);
+    v.resize(3);
+    v.shrink_to_fit();
+    EXPECT_EQ(v.size(), 3u);
+    EXPECT_EQ(v[0], 7u);
+    EXPECT_EQ(v[2], 2u);
+
+    // clear of a shared buffer leaves the other copy intact
+    uintvector w = shared;
+    w.clear();
+    EXPECT_EQ(w.size(), 0u);
+    w.push_back(5);
+    EXPECT_EQ(shared.size(), 100u);
+    EXPECT_EQ(shared[0], 0u);
+    EXPECT_EQ(w[0], 5u);
+
+    big_integer x(1);
+    for (int i = 0; i < 1000; i++) {
+        x += x;
+    }
+    EXPECT_EQ(x, big_integer(1) << 1000);
+}
+
+namespace {
+    big_integer naive_pow_mod(big_integer base, big_integer exponent, big_integer const &m) {
+        big_integer res = 1;
+        base %= m;
+        while (exponent > 0) {
+            if ((exponent & 1) == 1) {
+                res = res * base % m;
+            }
+            base = base * base % m;
+            exponent >>= 1;
+        }
+        return res;
+    }
+}
+
+TEST(correctness, modular_context_odd_and_even) {
+    // Montgomery for odd moduli, Barrett for even ones, short and above karatsuba_threshold
+    for (int shift : {40, 95, 1500}) {
+        for (int delta : {-1, 1, 12, 99}) {
+            big_integer m = (big_integer(1) << shift) + delta * 1000003;
+            big_integer::modular_context ctx(m);
+            big_integer a = (big_integer(3) << (shift - 7)) + 12345;
+            big_integer b = -((big_integer(5) << (shift + 20)) + 777);
+            big_integer expected = (a * b) % m;
+            if (expected < 0) {
+                expected += m;
+            }
+            EXPECT_EQ(ctx.mul_mod(a, b), expected);
+            EXPECT_EQ(ctx.mul_mod(m - 1, m - 1), 1);
+            EXPECT_EQ(ctx.mul_mod(0, a), 0);
+            big_integer e = (big_integer(1) << 100) + 12345;
+            EXPECT_EQ(ctx.pow_mod(a, e), naive_pow_mod(a, e, m));
+            EXPECT_EQ(ctx.pow_mod(a, 0), 1);
+            EXPECT_EQ(ctx.pow_mod(a, 1), ctx.reduce(a));
+        }
+    }
+}
+
+TEST(correctness, modular_context_inverse) {
+    big_integer p("170141183460469231731687303715884105727");  // 2^127 - 1
+    big_integer::modular_context ctx(p);
+    big_integer a("1234567890123456789012345678901234567890");
+    big_integer inv = ctx.inverse_mod(a);
+    EXPECT_EQ(ctx.mul_mod(a, inv), 1);
+    EXPECT_EQ(ctx.pow_mod(a, -3), ctx.pow_mod(inv, 3));
+    // Fermat: a^(p - 1) = 1
+    EXPECT_EQ(ctx.pow_mod(a, p - 1), 1);
+
+    big_integer::modular_context even(big_integer(1) << 64);
+    EXPECT_THROW(even.inverse_mod(big_integer(6)), std::runtime_error);
+    EXPECT_EQ(even.mul_mod(even.inverse_mod(7), 7), 1);
+    // powers of the digit base reduce by dropping digits
+    big_integer three_1000 = 1;
+    for (int i = 0; i < 1000; i++) {
+        three_1000 *= 3;
+    }
+    for (int bits : {32, 64, 65, 96}) {
+        big_integer m = big_integer(1) << bits;
+        big_integer::modular_context power(m);
+        EXPECT_EQ(power.mul_mod(m - 1, m - 1), 1);
+        EXPECT_EQ(power.pow_mod(3, 1000), three_1000 % m);
+        EXPECT_EQ(power.mul_mod(-5, m + 7), m - 35);
+    }
+    EXPECT_THROW(big_integer::modular_context(1), std::runtime_error);
+}
+
+TEST(correctness, sqr_kernel_matches_mul) {
+    std::vector<size_t> sizes = {1, 2, 3, 7, 48, 111, 112, 113, 200, 255, 256, 300};
+    for (size_t n : sizes) {
+        std::vector<uint32_t> a(n), r1(2 * n), r2(2 * n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = i % 3 ? UINT32_MAX : static_cast<uint32_t>(i * 0x9e3779b9u);
+        }
+        limbs::sqr(r1.data(), a.data(), n);
+        limbs::mul_basecase(r2.data(), a.data(), n, a.data(), n);
+        EXPECT_EQ(r1, r2) << n;
+    }
+}
+
+TEST(correctness, pow_and_roots) {
+    big_integer a("-123456789012345678901");
+    big_integer p = 1;
+    for (unsigned e = 0; e < 40; e++) {
+        EXPECT_EQ(a.pow(e), p);
+        p *= a;
+    }
+    EXPECT_EQ(big_integer(0).pow(0), 1);
+    EXPECT_EQ(big_integer(2).pow(1000), big_integer(1) << 1000);
+    EXPECT_EQ(big_integer(-1).pow(UINT32_MAX), -1);
+    EXPECT_EQ(big_integer(-1).pow(UINT32_MAX - 1), 1);
+    EXPECT_EQ(big_integer(1).pow(UINT32_MAX), 1);
+
+    for (unsigned k = 1; k < 8; k++) {
+        for (int shift : {0, 10, 63, 64, 65, 200, 3000}) {
+            for (int delta : {-1, 0, 1}) {
+                big_integer x = (big_integer(7) << shift) + 5 + delta;
+                big_integer r = x.iroot(k);
+                EXPECT_TRUE(r.pow(k) <= x);
+                EXPECT_TRUE((r + 1).pow(k) > x);
+            }
+        }
+    }
+    big_integer b = (big_integer(1) << 2000) + 1;
+    EXPECT_EQ((b * b).isqrt(), b);
+    EXPECT_EQ((b * b - 1).isqrt(), b - 1);
+    EXPECT_EQ((-b.pow(3)).iroot(3), -b);
+    // roots of a degree about the bit length and above it
+    EXPECT_EQ(b.iroot(2000), 2);
+    EXPECT_EQ(b.iroot(2001), 1);
+    EXPECT_EQ((-b).iroot(4000000001u), -1);
+    EXPECT_EQ(big_integer(3).iroot(UINT32_MAX), 1);
+    EXPECT_EQ(big_integer(0).isqrt(), 0);
+    EXPECT_THROW(big_integer(-4).isqrt(), std::runtime_error);
+    EXPECT_THROW(big_integer(4).iroot(0), std::runtime_error);
+}
+
+namespace {
+    big_integer euclid(big_integer a, big_integer b) {
+        if (a < 0) {
+            a = -a;
+        }
+        if (b < 0) {
+            b = -b;
+        }
+        while (b != 0) {
+            a %= b;
+            std::swap(a, b);
+        }
+        return a;
+    }
+}
+
+TEST(correctness, gcd_lehmer_and_binary) {
+    big_integer f1 = 1, f2 = 1;
+    for (int i = 0; i < 3000; i++) {
+        big_integer t = f1 + f2;
+        f1 = f2;
+        f2 = t;
+    }
+    // consecutive Fibonacci numbers: every quotient is 1
+    EXPECT_EQ(gcd(f1, f2), 1);
+    big_integer g = (big_integer(1) << 300) + 12345;
+    std::vector<big_integer> values = {0, 1, -6, big_integer(1) << 64, f1 * g, -f2 * g * g,
+                                       (big_integer(3) << 4000) + 1, g * 1000000007};
+    for (auto const &a : values) {
+        for (auto const &b : values) {
+            big_integer d = gcd(a, b);
+            EXPECT_EQ(d, euclid(a, b));
+            big_integer x, y;
+            EXPECT_EQ(extended_gcd(a, b, x, y), d);
+            EXPECT_EQ(a * x + b * y, d);
+            if (a != 0 && b != 0) {
+                big_integer l = lcm(a, b);
+                EXPECT_EQ(l * d, a * b < 0 ? -(a * b) : a * b);
+            }
+        }
+    }
+    EXPECT_EQ(lcm(0, 5), 0);
+}
+
+TEST(correctness, small_fast_paths_at_word_boundaries) {
+    // sums and products of at most two digits, checked against the general path through a big offset
+    big_integer const big = big_integer(1) << 200;
+    std::vector<big_integer> values;
+    for (char const *s : {"0", "1", "4294967295", "4294967296", "18446744073709551615", "9223372036854775808"}) {
+        values.emplace_back(s);
+        values.push_back(-big_integer(s));
+    }
+    for (auto const &a : values) {
+        for (auto const &b : values) {
+            EXPECT_EQ(a + b, (a + big) + b - big);
+            EXPECT_EQ(a - b, (a + big) - b - big);
+            EXPECT_EQ(a * b, (a + big) * b - big * b);
+            big_integer c = a;
+            c += b;
+            EXPECT_EQ(c, a + b);
+            c -= b;
+            EXPECT_EQ(c, a);
+            if (b != 0) {
+                big_integer q = a / b, r = a % b;
+                EXPECT_EQ(q * b + r, a);
+                EXPECT_TRUE(r == 0 || (r < 0) == (a < 0));
+                EXPECT_TRUE((r < 0 ? -r : r) < (b < 0 ? -b : b));
+            }
+        }
+    }
+    EXPECT_EQ(big_integer("18446744073709551615") + big_integer("18446744073709551615"),
+              big_integer("36893488147419103230"));
+    EXPECT_EQ(big_integer("18446744073709551615") * big_integer("-18446744073709551615"),
+              big_integer("-340282366920938463426481119284349108225"));
+    EXPECT_EQ(big_integer("-4294967296") + big_integer("4294967296"), 0);
+}
+
+TEST(correctness, export_import_bytes) {
+    typedef big_integer::byte_order order;
+    typedef big_integer::sign_encoding encoding;
+    typedef std::vector<uint8_t> bytes;
+    EXPECT_EQ(big_integer(0).export_bytes(), bytes({0}));
+    EXPECT_EQ(big_integer(-1).export_bytes(), bytes({0xff}));
+    EXPECT_EQ(big_integer(128).export_bytes(), bytes({0x80, 0}));
+    EXPECT_EQ(big_integer(-128).export_bytes(), bytes({0x80}));
+    EXPECT_EQ(big_integer(-129).export_bytes(order::big_endian), bytes({0xff, 0x7f}));
+    EXPECT_EQ(big_integer(-255).export_bytes(order::big_endian, encoding::sign_magnitude), bytes({0x80, 0xff}));
+    EXPECT_EQ(big_integer(-1).export_bytes(order::little_endian, encoding::sign_magnitude), bytes({0x81}));
+    EXPECT_EQ(big_integer(-(big_integer(1) << 64)).export_bytes(), bytes({0, 0, 0, 0, 0, 0, 0, 0, 0xff}));
+
+    uint8_t const sign_extended[] = {0xfe, 0xff, 0xff, 0xff, 0xff, 0xff};
+    EXPECT_EQ(big_integer::import_bytes(sign_extended, 6), -2);
+    EXPECT_EQ(big_integer::import_bytes(sign_extended, 0), 0);
+    uint8_t const negative_zero[] = {0, 0x80};
+    EXPECT_EQ(big_integer::import_bytes(negative_zero, 2, order::little_endian, encoding::sign_magnitude), 0);
+
+    std::vector<big_integer> values = {0, 1, -1, 127, 128, -128, -129, 255, -256, INT32_MIN,
+                                       big_integer(1) << 31, -(big_integer(1) << 32), (big_integer(1) << 64) - 1};
+    for (size_t n : {7, 50}) {
+        big_integer a = rand_big(n);
+        values.push_back(a);
+        values.push_back(-a);
+    }
+    for (auto const &a : values) {
+        for (order o : {order::little_endian, order::big_endian}) {
+            for (encoding e : {encoding::twos_complement, encoding::sign_magnitude}) {
+                bytes b = a.export_bytes(o, e);
+                EXPECT_EQ(big_integer::import_bytes(b.data(), b.size(), o, e), a);
+                if (b.size() > 1) {
+                    // the shortest form: one byte less could not hold the number
+                    bytes shorter = o == order::little_endian ? bytes(b.begin(), b.end() - 1) : bytes(b.begin() + 1, b.end());
+                    EXPECT_NE(big_integer::import_bytes(shorter.data(), shorter.size(), o, e), a);
+                }
+            }
+        }
+    }
+}
+
+TEST(correctness, big_integer_view_borrows_digits) {
+    uint32_t digits[] = {5, 0, 7, 0, 0, 0, 0, 1, 0, 0};
+    big_integer expected = (big_integer(1) << 224) + (big_integer(7) << 64) + 5;
+    big_integer_view v(digits, 10), w(digits, 3, true);
+    EXPECT_EQ(v, expected);
+    EXPECT_EQ(w, -((big_integer(7) << 64) + 5));
+    EXPECT_EQ(to_string(v.number()), to_string(expected));
+    EXPECT_EQ(v * v, expected * expected);
+    EXPECT_EQ(v + w, (big_integer(1) << 224));
+    EXPECT_EQ(v / w, expected / -((big_integer(7) << 64) + 5));
+    EXPECT_EQ(big_integer_view(digits + 3, 4), 0);
+    EXPECT_EQ(big_integer_view(digits, 0, true), 0);
+
+    // copies own their digits, writes never reach the borrowed ones
+    big_integer c = v, d = w;
+    c += 1;
+    c *= 3;
+    d <<= 5;
+    d = -d;
+    big_integer_view copy = v;
+    copy = w;
+    EXPECT_EQ(c, (expected + 1) * 3);
+    EXPECT_EQ(d, ((big_integer(7) << 64) + 5) << 5);
+    EXPECT_EQ(copy, w);
+    EXPECT_EQ(digits[0], 5u);
+    EXPECT_EQ(digits[2], 7u);
+    EXPECT_EQ(v, expected);
+}
+
+TEST(correctness, power_of_two_radix_strings) {
+    big_integer a = (big_integer(1) << 100) - 1;
+    EXPECT_EQ(to_string(a, 16), std::string(25, 'f'));
+    EXPECT_EQ(to_string(-a - 1, 2), "-1" + std::string(100, '0'));
+    EXPECT_EQ(to_string(big_integer(8), 8), "10");
+    EXPECT_EQ(to_string(big_integer(-1023), 32), "-vv");
+    EXPECT_EQ(to_string(big_integer(0), 16), "0");
+    EXPECT_EQ(big_integer("-DeadBeef", 16), -big_integer("3735928559"));
+    EXPECT_EQ(big_integer("+0000ff", 16), 255);
+    EXPECT_EQ(big_integer("-0", 2), 0);
+    EXPECT_THROW(big_integer("12", 7), std::runtime_error);
+    EXPECT_THROW(big_integer("102", 2), std::runtime_error);
+    EXPECT_THROW(big_integer("g", 16), std::runtime_error);
+    EXPECT_THROW(big_integer("-", 16), std::runtime_error);
+
+    for (size_t n : {1, 3, 40, 300}) {
+        big_integer x = rand_big(n);
+        for (unsigned base : {2u, 8u, 10u, 16u, 32u}) {
+            EXPECT_EQ(big_integer(to_string(x, base), base), x);
+            EXPECT_EQ(big_integer(to_string(-x, base), base), -x);
+        }
+        EXPECT_EQ(to_string(x, 10), to_string(x));
+    }
+}
+
+TEST(correctness, stream_extraction) {
+    std::istringstream in("  123456789012345678901234567890 -42\n+7 ff -0x 9");
+    big_integer a, b, c, d, e;
+    in >> a >> b >> c >> std::hex >> d;
+    EXPECT_EQ(a, big_integer("123456789012345678901234567890"));
+    EXPECT_EQ(b, -42);
+    EXPECT_EQ(c, 7);
+    EXPECT_EQ(d, 255);
+    // "-0x": the sign and 0 are digits, x stops the number
+    in >> e;
+    EXPECT_EQ(e, 0);
+    EXPECT_TRUE(in.good());
+    in >> e;
+    EXPECT_TRUE(in.fail());
+
+    std::istringstream bad("abc");
+    bad >> e;
+    EXPECT_TRUE(bad.fail());
+    EXPECT_EQ(e, 0);
+
+    std::ostringstream out;
+    out << std::hex << big_integer(-255) << ' ' << std::oct << big_integer(64) << ' ' << std::dec << big_integer(10);
+    EXPECT_EQ(out.str(), "-ff 100 10");
+    std::istringstream back(to_string(rand_big(100), 16));
+    back >> std::hex >> e;
+    EXPECT_TRUE(back.eof());
+    EXPECT_EQ(to_string(e, 16), back.str());
+}
+
+namespace {
+    // x reduced to the range of fixed_integer<Bits, Signed>
+    template<size_t Bits, bool Signed>
+    big_integer wrap(big_integer const &x) {
+        big_integer r = x & ((big_integer(1) << Bits) - 1);
+        if (Signed && r >= (big_integer(1) << (Bits - 1))) {
+            r -= big_integer(1) << Bits;
+        }
+        return r;
+    }
+
+    template<size_t Bits, bool Signed>
+    void check_fixed_integer() {
+        typedef fixed_integer<Bits, Signed> fixed;
+        auto ref = wrap<Bits, Signed>;
+        for (int iter = 0; iter < 50; iter++) {
+            big_integer a = wrap<Bits, Signed>(rand_big(Bits / 32 + 1) * (iter % 2 ? -1 : 1));
+            big_integer b = iter % 3 ? rand_big(1 + iter % (Bits / 32)) : rand_big(Bits / 32);
+            b = wrap<Bits, Signed>(iter % 5 ? b : -b);
+            if (b == 0) {
+                b = 3;
+            }
+            fixed x(a), y(b);
+            int k = int(iter * 7 % Bits);
+            EXPECT_EQ(big_integer(x), a);
+            EXPECT_EQ(fixed(to_string(a)), x);
+            EXPECT_EQ(to_string(x), to_string(a));
+            EXPECT_EQ(big_integer(x + y), ref(a + b));
+            EXPECT_EQ(big_integer(x - y), ref(a - b));
+            EXPECT_EQ(big_integer(x * y), ref(a * b));
+            EXPECT_EQ(big_integer(x / y), ref(a / b));
+            EXPECT_EQ(big_integer(x % y), ref(a % b));
+            EXPECT_EQ(big_integer(x & y), ref(a & b));
+            EXPECT_EQ(big_integer(x | y), ref(a | b));
+            EXPECT_EQ(big_integer(x ^ y), ref(a ^ b));
+            EXPECT_EQ(big_integer(~x), ref(~a));
+            EXPECT_EQ(big_integer(-x), ref(-a));
+            EXPECT_EQ(big_integer(x << k), ref(a << k));
+            EXPECT_EQ(big_integer(x >> k), a >> k);
+            EXPECT_EQ(x < y, a < b);
+            EXPECT_EQ(x == y, a == b);
+            EXPECT_EQ(x >= x, true);
+        }
+    }
+}
+
+TEST(correctness, fixed_integer_matches_big_integer) {
+    // usable in constant expressions
+    constexpr fixed_integer<128> a("-170141183460469231731687303715884105728");
+    static_assert(a - 1 == -(a + 1), "wrapping subtraction");
+    static_assert(-a == a && a < 0, "the minimum is its own negation");
+    static_assert(fixed_integer<256>("340282366920938463463374607431768211456") / 3 % 1000 == 485, "division");
+    static_assert((fixed_integer<128>(-7) >> 1) == -4 && fixed_integer<128>(-7) / 2 == -3, "shifts floor, division truncates");
+    static_assert(fixed_integer<128, false>(-1) > fixed_integer<128, false>(1), "unsigned comparison");
+    EXPECT_EQ(big_integer(a), -(big_integer(1) << 127));
+    EXPECT_EQ(fixed_integer<64>(big_integer("18446744073709551615")), -1);
+    EXPECT_EQ(big_integer(fixed_integer<192>(fixed_integer<64, false>(-1))), big_integer("18446744073709551615"));
+    EXPECT_EQ(big_integer(fixed_integer<192>(fixed_integer<64>(-1))), -1);
+    EXPECT_THROW(fixed_integer<128>(1) / 0, std::runtime_error);
+    EXPECT_THROW(fixed_integer<128>("12a"), std::runtime_error);
+
+    check_fixed_integer<64, true>();
+    check_fixed_integer<128, true>();
+    check_fixed_integer<128, false>();
+    check_fixed_integer<256, true>();
+    check_fixed_integer<512, false>();
+}
+
+TEST(correctness, batch_add_sub) {
+    std::vector<big_integer> a, b;
+    for (size_t i = 0; i < 400; i++) {
+        size_t n = i % 7 ? i % 4 : 300 + i;
+        a.push_back(i % 3 ? rand_big(n) : -rand_big(n));
+        b.push_back(i % 2 ? rand_big(i % 5) : -rand_big(n));
+    }
+    a[1] = b[1];
+    a[2] = -b[2];
+    b[3] = 0;
+    std::vector<big_integer> sums, differences;
+    for (size_t i = 0; i < a.size(); i++) {
+        sums.push_back(a[i] + b[i]);
+        differences.push_back(a[i] - b[i]);
+    }
+    for (size_t threads : {1, 4}) {
+        big_integer::set_multiplication_threads(threads, 64);
+        // results over old digits, shared or not, and over either operand
+        std::vector<big_integer> res = a, res_a = a, res_b = b;
+        big_integer::add_many(a.data(), b.data(), res.data(), a.size());
+        EXPECT_EQ(res, sums);
+        big_integer::sub_many(a.data(), b.data(), res.data(), a.size());
+        EXPECT_EQ(res, differences);
+        big_integer::sub_many(res_a.data(), b.data(), res_a.data(), a.size());
+        EXPECT_EQ(res_a, differences);
+        big_integer::sub_many(a.data(), res_b.data(), res_b.data(), a.size());
+        EXPECT_EQ(res_b, differences);
+        big_integer::add_many(res_b.data(), res_b.data(), res_b.data(), a.size());
+        big_integer::sub_many(res_b.data(), differences.data(), res_b.data(), a.size());
+        EXPECT_EQ(res_b, differences);
+        // results preallocated as copies of one long number
+        std::vector<big_integer> copies(a.size(), a[7]);
+        big_integer::add_many(a.data(), b.data(), copies.data(), a.size());
+        EXPECT_EQ(copies, sums);
+        copies.assign(a.size(), a[7]);
+        big_integer::sub_many(copies.data(), b.data(), copies.data(), a.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_EQ(copies[i], a[7] - b[i]);
+        }
+    }
+    big_integer::set_multiplication_threads(1);
+    EXPECT_EQ(to_string(sums[2]), "0");
+}
+
+TEST(correctness, sum_and_product_reductions) {
+    EXPECT_EQ(big_integer::sum(nullptr, 0), 0);
+    EXPECT_EQ(big_integer::product(nullptr, 0), 1);
+    std::vector<big_integer> values;
+    for (size_t i = 0; i < 300; i++) {
+        values.push_back(i % 2 ? rand_big(i % 9) : -rand_big(50 + i));
+    }
+    // terms cancelling each other to zero
+    std::vector<big_integer> cancelling = {values[0], -values[0]};
+    EXPECT_EQ(to_string(big_integer::sum(cancelling.data(), 2)), "0");
+
+    big_integer sum = 0, product = 1;
+    for (size_t i = 0; i < 61; i++) {
+        sum += values[i];
+        product *= values[i];
+    }
+    EXPECT_EQ(big_integer::sum(values.data(), 61), sum);
+    EXPECT_EQ(big_integer::product(values.data(), 61), product);
+    EXPECT_EQ(big_integer::product(values.data() + 5, 1), values[5]);
+    std::vector<big_integer> ones(100, (big_integer(1) << 64) - 1);
+    EXPECT_EQ(big_integer::sum(ones.data(), 100), ((big_integer(1) << 64) - 1) * 100);
+
+    big_integer all_sum = big_integer::sum(values.data(), values.size());
+    big_integer all_product = big_integer::product(values.data(), values.size());
+    big_integer::set_multiplication_threads(4, 64);
+    EXPECT_EQ(big_integer::sum(values.data(), values.size()), all_sum);
+    EXPECT_EQ(big_integer::product(values.data(), values.size()), all_product);
+    big_integer::set_multiplication_threads(1);
+}
+
+TEST(correctness, product_and_remainder_trees) {
+    std::vector<big_integer> factors;
+    big_integer factorial = 1;
+    for (int i = 1; i <= 300; i++) {
+        factors.push_back(i);
+        factorial *= i;
+    }
+    EXPECT_EQ(big_integer::product(factors.data(), factors.size()), factorial);
+
+    std::vector<big_integer> moduli = {1, 2, -3, big_integer(1) << 32, -rand_big(3), 97};
+    for (size_t i = 0; i < 150; i++) {
+        moduli.push_back(rand_big(i % 11 ? i % 5 : 40 + i) + 1);
+    }
+    big_integer x = rand_big(3000);
+    EXPECT_TRUE(big_integer::remainders(x, moduli.data(), 0).empty());
+    EXPECT_EQ(big_integer::remainders(-x, moduli.data() + 4, 1), std::vector<big_integer>({-x % moduli[4]}));
+    for (size_t threads : {1, 4}) {
+        big_integer::set_multiplication_threads(threads, 64);
+        for (big_integer const &a : {x, -x, big_integer(0), big_integer(12345)}) {
+            std::vector<big_integer> rem = big_integer::remainders(a, moduli.data(), moduli.size());
+            ASSERT_EQ(rem.size(), moduli.size());
+            for (size_t i = 0; i < moduli.size(); i++) {
+                EXPECT_EQ(rem[i], a % moduli[i]);
+            }
+        }
+    }
+    // moduli longer than the number: every remainder is the number itself, read by both children,
+    // which odd chunk boundaries put into different threads
+    std::vector<big_integer> longer;
+    for (size_t i = 0; i < 70; i++) {
+        longer.push_back(rand_big(30 + i % 3) + 1);
+    }
+    big_integer y = -rand_big(10);
+    for (size_t threads : {1, 4}) {
+        big_integer::set_multiplication_threads(threads, 8);
+        EXPECT_EQ(big_integer::remainders(y, longer.data(), longer.size()), std::vector<big_integer>(longer.size(), y));
+    }
+    big_integer::set_multiplication_threads(1);
+    moduli[7] = 0;
+    EXPECT_THROW(big_integer::remainders(x, moduli.data(), moduli.size()), std::runtime_error);
+}
+
+TEST(correctness, probable_primes) {
+    size_t const N = 20000;
+    std::vector<bool> composite(N);
+    for (size_t i = 2; i < N; i++) {
+        for (size_t j = i * i; !composite[i] && j < N; j += i) {
+            composite[j] = true;
+        }
+        EXPECT_EQ(big_integer(int(i)).is_probable_prime(), !composite[i]) << i;
+    }
+    EXPECT_FALSE(big_integer(0).is_probable_prime());
+    EXPECT_FALSE(big_integer(1).is_probable_prime());
+    EXPECT_FALSE(big_integer(-7).is_probable_prime());
+    // a Carmichael number and strong pseudoprimes to base 2, the last one to bases up to 31
+    EXPECT_FALSE(big_integer(561).is_probable_prime());
+    EXPECT_FALSE(big_integer("3215031751").is_probable_prime());
+    EXPECT_FALSE(big_integer("3825123056546413051").is_probable_prime());
+
+    big_integer m89 = (big_integer(1) << 89) - 1, m127 = (big_integer(1) << 127) - 1;
+    EXPECT_TRUE(m89.is_probable_prime());
+    EXPECT_TRUE(m127.is_probable_prime(10));
+    EXPECT_TRUE(big_integer("1000000007").is_probable_prime(3));
+    EXPECT_FALSE(((big_integer(1) << 128) + 1).is_probable_prime());
+    EXPECT_FALSE((m89 * m127).is_probable_prime());
+    EXPECT_FALSE((m127 * m127).is_probable_prime());
+
+    EXPECT_EQ(big_integer(-5).next_prime(), 2);
+    EXPECT_EQ(big_integer(2).next_prime(), 3);
+    EXPECT_EQ(big_integer(7).next_prime(), 11);
+    EXPECT_EQ(big_integer(1000).next_prime(), 1009);
+    EXPECT_EQ((big_integer(1) << 100).next_prime(), (big_integer(1) << 100) + 277);
+    EXPECT_EQ((m127 - 1).next_prime(), m127);
+}
@@ -0,0 +1,34 @@
+#include "big_integer_view.h"
+#include "limb_ops.h"
+
+namespace {
+    // borrowed by views of zero, which have no digits of their own
+    uint32_t const ZERO_DIGIT = 0;
+}
+
+big_integer_view::big_integer_view(uint32_t const *digits, size_t n, bool negative) {
+    n = limbs::normalized_size(digits, n);
+    if (n == 0) {
+        value.value = uintvector::borrowed(&ZERO_DIGIT, 1);
+        return;
+    }
+    value.value = uintvector::borrowed(digits, n);
+    value.sign = negative ? -1 : 1;
+}
+
+big_integer_view::big_integer_view(big_integer_view const &other)
+        : big_integer_view(other.value.value.data(), other.value.value.size(), other.value.sign < 0) {}
+
+big_integer_view &big_integer_view::operator=(big_integer_view const &other) {
+    value.value = uintvector::borrowed(other.value.value.data(), other.value.value.size());
+    value.sign = other.value.sign;
+    return *this;
+}
+
+big_integer_view::operator big_integer const &() const {
+    return value;
+}
+
+big_integer const &big_integer_view::number() const {
+    return value;
+}
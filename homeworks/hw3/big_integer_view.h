@@ -0,0 +1,26 @@
+#ifndef BIGINT_HW3_BIG_INTEGER_VIEW_H
+#define BIGINT_HW3_BIG_INTEGER_VIEW_H
+
+#include "big_integer.h"
+
+// Read-only number over little-endian 32-bit digits stored elsewhere, for example in
+// a memory mapped file. Nothing is copied: the digits must outlive the view and stay unchanged.
+// The view passes for a big_integer const & anywhere; copies made of that number own their digits.
+struct big_integer_view {
+    // digits[0..n), leading zero digits are allowed
+    big_integer_view(uint32_t const *digits, size_t n, bool negative = false);
+
+    // a view of the same digits
+    big_integer_view(big_integer_view const &other);
+
+    big_integer_view &operator=(big_integer_view const &other);
+
+    operator big_integer const &() const;
+
+    big_integer const &number() const;
+
+private:
+    big_integer value;
+};
+
+#endif //BIGINT_HW3_BIG_INTEGER_VIEW_H
@@ -0,0 +1,432 @@
+#ifndef BIGINT_HW3_FIXED_INTEGER_H
+#define BIGINT_HW3_FIXED_INTEGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "big_integer.h"
+
+// Integer of exactly Bits bits (a multiple of 64) in inline 64-bit limbs, two's complement.
+// Arithmetic wraps modulo 2^Bits for both signed and unsigned numbers, division truncates
+// like big_integer's, right shifts of signed numbers round toward minus infinity.
+// Everything but the std::string and big_integer conversions is constexpr.
+
+// Loops over the limbs, whose count is known at compile time, are unrolled completely
+#if defined(__clang__)
+#define FIXED_INTEGER_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define FIXED_INTEGER_UNROLL _Pragma("GCC unroll 16")
+#else
+#define FIXED_INTEGER_UNROLL
+#endif
+
+namespace fixed_limbs {
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    // q = a / b, r = a % b for n-limb magnitudes, b != 0
+    template<size_t N>
+    constexpr void divrem(uint64_t *q, uint64_t *r, uint64_t const *a, uint64_t const *b) {
+        size_t an = N, bn = N;
+        while (an > 0 && a[an - 1] == 0) {
+            an--;
+        }
+        while (bn > 0 && b[bn - 1] == 0) {
+            bn--;
+        }
+        for (size_t i = 0; i < N; i++) {
+            q[i] = 0;
+            r[i] = i < an ? a[i] : 0;
+        }
+        if (an < bn) {
+            return;
+        }
+        if (bn == 1) {
+            uint128_t rem = 0;
+            for (size_t i = an; i-- > 0;) {
+                uint128_t cur = rem << 64 | a[i];
+                q[i] = static_cast<uint64_t>(cur / b[0]);
+                rem = cur % b[0];
+            }
+            for (size_t i = 0; i < N; i++) {
+                r[i] = 0;
+            }
+            r[0] = static_cast<uint64_t>(rem);
+            return;
+        }
+        // a single limb divisor is all there is for N == 1
+        if constexpr (N > 1) {
+            // Knuth's algorithm D on normalized copies: the top bit of the divisor is set
+            unsigned s = 0;
+            while (!(b[bn - 1] << s >> 63)) {
+                s++;
+            }
+            uint64_t u[N + 1] = {}, v[N] = {};
+            for (size_t i = 0; i < bn; i++) {
+                v[i] = b[i] << s | (s && i ? b[i - 1] >> (64 - s) : 0);
+            }
+            for (size_t i = 0; i <= an; i++) {
+                u[i] = (i < an ? a[i] << s : 0) | (s && i ? a[i - 1] >> (64 - s) : 0);
+            }
+            for (size_t j = an - bn + 1; j-- > 0;) {
+                uint128_t num = uint128_t(u[j + bn]) << 64 | u[j + bn - 1];
+                uint128_t qhat = num / v[bn - 1], rhat = num % v[bn - 1];
+                while ((qhat >> 64) || qhat * v[bn - 2] > (rhat << 64 | u[j + bn - 2])) {
+                    qhat--;
+                    rhat += v[bn - 1];
+                    if (rhat >> 64) {
+                        break;
+                    }
+                }
+                uint64_t borrow = 0;
+                for (size_t i = 0; i < bn; i++) {
+                    uint128_t p = qhat * v[i] + borrow;
+                    auto lo = static_cast<uint64_t>(p);
+                    borrow = static_cast<uint64_t>(p >> 64) + (u[i + j] < lo);
+                    u[i + j] -= lo;
+                }
+                if (u[j + bn] < borrow) {
+                    // the estimate was one too large
+                    qhat--;
+                    uint64_t carry = 0;
+                    for (size_t i = 0; i < bn; i++) {
+                        uint128_t t = uint128_t(u[i + j]) + v[i] + carry;
+                        u[i + j] = static_cast<uint64_t>(t);
+                        carry = static_cast<uint64_t>(t >> 64);
+                    }
+                }
+                u[j + bn] = 0;
+                q[j] = static_cast<uint64_t>(qhat);
+            }
+            for (size_t i = 0; i < N; i++) {
+                r[i] = i < bn ? u[i] >> s | (s ? u[i + 1] << (64 - s) : 0) : 0;
+            }
+        }
+    }
+}
+
+template<size_t Bits, bool Signed = true>
+struct fixed_integer {
+    static_assert(Bits > 0 && Bits % 64 == 0, "fixed_integer width must be a positive multiple of 64");
+
+    static constexpr size_t LIMBS = Bits / 64;
+
+    constexpr fixed_integer() = default;
+
+    // sign-extended for negative x, truncated to Bits as with the built-in conversions
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    constexpr fixed_integer(T x) {
+        auto v = static_cast<int64_t>(x);
+        d[0] = static_cast<uint64_t>(x);
+        uint64_t fill = std::is_signed<T>::value && v < 0 ? ~uint64_t(0) : 0;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 1; i < LIMBS; i++) {
+            d[i] = fill;
+        }
+    }
+
+    // other widths and signedness: truncated, or extended by the sign of a signed source
+    template<size_t B, bool S>
+    explicit constexpr fixed_integer(fixed_integer<B, S> const &x) {
+        uint64_t fill = x.is_negative() ? ~uint64_t(0) : 0;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            d[i] = i < x.LIMBS ? x.d[i] : fill;
+        }
+    }
+
+    // optional sign and decimal digits, throws otherwise; usable in constant expressions
+    explicit constexpr fixed_integer(char const *str) {
+        bool negative = *str == '-';
+        if (*str == '-' || *str == '+') {
+            str++;
+        }
+        if (!*str) {
+            throw std::runtime_error("Invalid number format");
+        }
+        for (; *str; str++) {
+            if (*str < '0' || *str > '9') {
+                throw std::runtime_error("Invalid number format");
+            }
+            *this = *this * fixed_integer(10) + fixed_integer(*str - '0');
+        }
+        if (negative) {
+            *this = -*this;
+        }
+    }
+
+    explicit fixed_integer(std::string const &str) : fixed_integer(str.c_str()) {}
+
+    // the low Bits of the two's complement of x
+    explicit fixed_integer(big_integer const &x) {
+        uint32_t const *digits = x.value.data();
+        for (size_t i = 0; i < x.value.size() && i < 2 * LIMBS; i++) {
+            d[i / 2] |= uint64_t(digits[i]) << (32 * (i % 2));
+        }
+        if (x.sign < 0) {
+            *this = -*this;
+        }
+    }
+
+    explicit operator big_integer() const {
+        fixed_integer magnitude = is_negative() ? -*this : *this;
+        big_integer res;
+        res.value.resize(2 * LIMBS);
+        uint32_t *digits = res.value.mutable_data();
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < 2 * LIMBS; i++) {
+            digits[i] = static_cast<uint32_t>(magnitude.d[i / 2] >> (32 * (i % 2)));
+        }
+        res.shrink_to_fit();
+        res.sign = is_negative() ? -1 : 1;
+        return res;
+    }
+
+    constexpr bool is_negative() const {
+        return Signed && d[LIMBS - 1] >> 63;
+    }
+
+    // limb i, little-endian
+    constexpr uint64_t limb(size_t i) const {
+        return d[i];
+    }
+
+    constexpr fixed_integer &operator+=(fixed_integer const &rhs) {
+        uint64_t carry = 0;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t s = d[i] + rhs.d[i];
+            uint64_t next = s < d[i];
+            d[i] = s + carry;
+            carry = next | (d[i] < s);
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator-=(fixed_integer const &rhs) {
+        uint64_t borrow = 0;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t diff = d[i] - rhs.d[i];
+            uint64_t next = d[i] < rhs.d[i];
+            d[i] = diff - borrow;
+            borrow = next | (diff < borrow);
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator*=(fixed_integer const &rhs) {
+        // the low LIMBS limbs of the product, rows shortened accordingly
+        uint64_t r[LIMBS] = {};
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+            FIXED_INTEGER_UNROLL
+            for (size_t j = 0; i + j < LIMBS; j++) {
+                fixed_limbs::uint128_t t = fixed_limbs::uint128_t(d[i]) * rhs.d[j] + r[i + j] + carry;
+                r[i + j] = static_cast<uint64_t>(t);
+                carry = static_cast<uint64_t>(t >> 64);
+            }
+        }
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            d[i] = r[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator/=(fixed_integer const &rhs) {
+        return *this = divmod(*this, rhs).first;
+    }
+
+    constexpr fixed_integer &operator%=(fixed_integer const &rhs) {
+        return *this = divmod(*this, rhs).second;
+    }
+
+    constexpr fixed_integer &operator&=(fixed_integer const &rhs) {
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            d[i] &= rhs.d[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator|=(fixed_integer const &rhs) {
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            d[i] |= rhs.d[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator^=(fixed_integer const &rhs) {
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            d[i] ^= rhs.d[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator<<=(int rhs) {
+        if (rhs < 0) {
+            shift_right(size_t(-int64_t(rhs)));
+        } else {
+            shift_left(size_t(rhs));
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer &operator>>=(int rhs) {
+        if (rhs < 0) {
+            shift_left(size_t(-int64_t(rhs)));
+        } else {
+            shift_right(size_t(rhs));
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer operator+() const {
+        return *this;
+    }
+
+    constexpr fixed_integer operator-() const {
+        return fixed_integer() - *this;
+    }
+
+    constexpr fixed_integer operator~() const {
+        fixed_integer res;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.d[i] = ~d[i];
+        }
+        return res;
+    }
+
+    constexpr fixed_integer &operator++() {
+        return *this += 1;
+    }
+
+    constexpr fixed_integer operator++(int) {
+        fixed_integer res = *this;
+        *this += 1;
+        return res;
+    }
+
+    constexpr fixed_integer &operator--() {
+        return *this -= 1;
+    }
+
+    constexpr fixed_integer operator--(int) {
+        fixed_integer res = *this;
+        *this -= 1;
+        return res;
+    }
+
+    friend constexpr int compare(fixed_integer const &a, fixed_integer const &b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative() ? -1 : 1;
+        }
+        // same sign: two's complement limbs order like unsigned ones
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (a.d[i] != b.d[i]) {
+                return a.d[i] < b.d[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    friend constexpr bool operator==(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) == 0; }
+
+    friend constexpr bool operator!=(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) != 0; }
+
+    friend constexpr bool operator<(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) < 0; }
+
+    friend constexpr bool operator>(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) > 0; }
+
+    friend constexpr bool operator<=(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) <= 0; }
+
+    friend constexpr bool operator>=(fixed_integer const &a, fixed_integer const &b) { return compare(a, b) >= 0; }
+
+    friend constexpr fixed_integer operator+(fixed_integer a, fixed_integer const &b) { return a += b; }
+
+    friend constexpr fixed_integer operator-(fixed_integer a, fixed_integer const &b) { return a -= b; }
+
+    friend constexpr fixed_integer operator*(fixed_integer a, fixed_integer const &b) { return a *= b; }
+
+    friend constexpr fixed_integer operator/(fixed_integer const &a, fixed_integer const &b) {
+        return divmod(a, b).first;
+    }
+
+    friend constexpr fixed_integer operator%(fixed_integer const &a, fixed_integer const &b) {
+        return divmod(a, b).second;
+    }
+
+    friend constexpr fixed_integer operator&(fixed_integer a, fixed_integer const &b) { return a &= b; }
+
+    friend constexpr fixed_integer operator|(fixed_integer a, fixed_integer const &b) { return a |= b; }
+
+    friend constexpr fixed_integer operator^(fixed_integer a, fixed_integer const &b) { return a ^= b; }
+
+    friend constexpr fixed_integer operator<<(fixed_integer a, int b) { return a <<= b; }
+
+    friend constexpr fixed_integer operator>>(fixed_integer a, int b) { return a >>= b; }
+
+    // Quotient and remainder of truncating division, throws on division by zero
+    friend constexpr std::pair<fixed_integer, fixed_integer> divmod(fixed_integer const &a, fixed_integer const &b) {
+        if (b == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        fixed_integer x = a.is_negative() ? -a : a, y = b.is_negative() ? -b : b, q, r;
+        fixed_limbs::divrem<LIMBS>(q.d, r.d, x.d, y.d);
+        if (a.is_negative() != b.is_negative()) {
+            q = -q;
+        }
+        if (a.is_negative()) {
+            r = -r;
+        }
+        return {q, r};
+    }
+
+    friend std::string to_string(fixed_integer const &a) {
+        return to_string(big_integer(a));
+    }
+
+    friend std::ostream &operator<<(std::ostream &s, fixed_integer const &a) {
+        return s << big_integer(a);
+    }
+
+   private:
+    template<size_t B, bool S>
+    friend struct fixed_integer;
+
+    constexpr void shift_left(size_t cnt) {
+        size_t whole = cnt / 64;
+        unsigned bits = cnt % 64;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint64_t hi = i >= whole ? d[i - whole] : 0;
+            uint64_t lo = i >= whole + 1 ? d[i - whole - 1] : 0;
+            d[i] = bits ? hi << bits | lo >> (64 - bits) : hi;
+        }
+    }
+
+    // sign bits come in from the top of a signed number
+    constexpr void shift_right(size_t cnt) {
+        uint64_t fill = is_negative() ? ~uint64_t(0) : 0;
+        size_t whole = cnt / 64;
+        unsigned bits = cnt % 64;
+        FIXED_INTEGER_UNROLL
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t lo = i + whole < LIMBS ? d[i + whole] : fill;
+            uint64_t hi = i + whole + 1 < LIMBS ? d[i + whole + 1] : fill;
+            d[i] = bits ? lo >> bits | hi << (64 - bits) : lo;
+        }
+    }
+
+    uint64_t d[LIMBS] = {};
+};
+
+#undef FIXED_INTEGER_UNROLL
+
+#endif //BIGINT_HW3_FIXED_INTEGER_H
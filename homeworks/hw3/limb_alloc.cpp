@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+#include "limb_alloc.h"
+
+namespace limb_alloc {
+    size_t const pool_max_bytes = size_t(1) << 16;
+
+    namespace {
+        thread_local allocator *active = nullptr;
+
+        struct heap_allocator final : allocator {
+            void *allocate(size_t bytes) override {
+                return ::operator new(bytes);
+            }
+
+            void deallocate(void *p, size_t) noexcept override {
+                ::operator delete(p);
+            }
+        };
+
+        // size class c holds blocks of 2^(c + MIN_CLASS_BITS) bytes
+        size_t const MIN_CLASS_BITS = 5;
+        size_t const CLASSES = 12;
+        // blocks kept per class, the rest goes back to the heap
+        size_t const CACHED_BLOCKS = 32;
+
+        size_t size_class(size_t bytes) {
+            size_t c = 0;
+            while ((size_t(1) << (c + MIN_CLASS_BITS)) < bytes) {
+                c++;
+            }
+            return c;
+        }
+
+        struct free_block {
+            free_block *next;
+        };
+
+        // set when the cache of the thread is destroyed, blocks freed later go to the heap
+        thread_local bool cache_closed = false;
+
+        struct pool_cache {
+            free_block *head[CLASSES] = {};
+            size_t count[CLASSES] = {};
+
+            ~pool_cache() {
+                cache_closed = true;
+                for (free_block *block : head) {
+                    while (block) {
+                        free_block *next = block->next;
+                        ::operator delete(block);
+                        block = next;
+                    }
+                }
+            }
+        };
+
+        pool_cache &cache() {
+            thread_local pool_cache c;
+            return c;
+        }
+
+        // Stateless: the cache is looked up on the thread that calls it,
+        // blocks carry no owner and any thread may reuse them
+        struct pool_allocator final : allocator {
+            void *allocate(size_t bytes) override {
+                if (bytes > pool_max_bytes || cache_closed) {
+                    return ::operator new(bytes);
+                }
+                size_t c = size_class(bytes);
+                pool_cache &pc = cache();
+                if (free_block *block = pc.head[c]) {
+                    pc.head[c] = block->next;
+                    pc.count[c]--;
+                    return block;
+                }
+                return ::operator new(size_t(1) << (c + MIN_CLASS_BITS));
+            }
+
+            void deallocate(void *p, size_t bytes) noexcept override {
+                if (bytes > pool_max_bytes || cache_closed) {
+                    ::operator delete(p);
+                    return;
+                }
+                size_t c = size_class(bytes);
+                pool_cache &pc = cache();
+                if (pc.count[c] == CACHED_BLOCKS) {
+                    ::operator delete(p);
+                    return;
+                }
+                auto *block = static_cast<free_block *>(p);
+                block->next = pc.head[c];
+                pc.head[c] = block;
+                pc.count[c]++;
+            }
+        };
+
+        heap_allocator heap_instance;
+        pool_allocator pool_instance;
+    }
+
+    allocator &current() {
+        return active ? *active : pool_instance;
+    }
+
+    allocator &heap() {
+        return heap_instance;
+    }
+
+    allocator &pool() {
+        return pool_instance;
+    }
+
+    scoped_allocator::scoped_allocator(allocator &a) : previous(active) {
+        active = &a;
+    }
+
+    scoped_allocator::~scoped_allocator() {
+        active = previous;
+    }
+
+    struct arena::state final : allocator {
+        size_t const chunk_bytes;
+        std::vector<char *> chunks;
+        char *pos = nullptr, *end = nullptr;
+        size_t used = 0;
+        // live blocks plus one for the scope, the last release frees the chunks
+        std::atomic<size_t> refs{1};
+
+        explicit state(size_t chunk_bytes) : chunk_bytes(chunk_bytes) {}
+
+        ~state() {
+            for (char *chunk : chunks) {
+                ::operator delete(chunk);
+            }
+        }
+
+        void *allocate(size_t bytes) override {
+            size_t const ALIGN = alignof(std::max_align_t);
+            bytes = (bytes + ALIGN - 1) / ALIGN * ALIGN;
+            if (size_t(end - pos) < bytes) {
+                size_t size = std::max(chunk_bytes, bytes);
+                chunks.reserve(chunks.size() + 1);
+                pos = static_cast<char *>(::operator new(size));
+                end = pos + size;
+                chunks.push_back(pos);
+            }
+            void *res = pos;
+            pos += bytes;
+            used += bytes;
+            refs.fetch_add(1, std::memory_order_relaxed);
+            return res;
+        }
+
+        void deallocate(void *, size_t) noexcept override {
+            release();
+        }
+
+        void release() noexcept {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+    };
+
+    arena::arena(size_t chunk_bytes) : st(new state(chunk_bytes)), previous(active) {
+        active = st;
+    }
+
+    arena::~arena() {
+        active = previous;
+        st->release();
+    }
+
+    size_t arena::used() const {
+        return st->used;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef BIGINT_HW3_LIMB_ALLOC_H
+#define BIGINT_HW3_LIMB_ALLOC_H
+
+#include <cstddef>
+
+// Allocators for the heap storage of uintvector (a reference counted header and digits).
+// Each thread has an active allocator: the innermost live scope, otherwise the thread's pool.
+// Every block remembers the allocator it came from, so it may be freed anywhere, any time.
+namespace limb_alloc {
+    struct allocator {
+        virtual void *allocate(size_t bytes) = 0;
+
+        virtual void deallocate(void *p, size_t bytes) noexcept = 0;
+
+    protected:
+        ~allocator() = default;
+    };
+
+    // allocator used for new storage by the calling thread
+    allocator &current();
+
+    // plain operator new and delete
+    allocator &heap();
+
+    // Per-thread size classes of powers of two up to pool_max_bytes, freed blocks are
+    // cached for reuse by the thread that frees them; larger blocks go to the heap
+    allocator &pool();
+
+    extern size_t const pool_max_bytes;
+
+    // Makes a an active allocator of the calling thread for the lifetime of the scope
+    struct scoped_allocator {
+        explicit scoped_allocator(allocator &a);
+
+        ~scoped_allocator();
+
+        scoped_allocator(scoped_allocator const &) = delete;
+
+        scoped_allocator &operator=(scoped_allocator const &) = delete;
+
+    private:
+        allocator *previous;
+    };
+
+    // Bump allocation from chunks of at least chunk_bytes, active for the lifetime of the scope:
+    // deallocation is free and the chunks are released together. Numbers that outlive
+    // the scope stay valid, they keep the chunks until the last of them is destroyed.
+    struct arena {
+        explicit arena(size_t chunk_bytes = 1 << 16);
+
+        ~arena();
+
+        arena(arena const &) = delete;
+
+        arena &operator=(arena const &) = delete;
+
+        // bytes taken from the chunks so far
+        size_t used() const;
+
+    private:
+        struct state;
+
+        state *st;
+        allocator *previous;
+    };
+}
+
+#endif //BIGINT_HW3_LIMB_ALLOC_H
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <vector>
+#include "limb_ops.h"
+
+namespace limbs {
+    size_t bz_threshold = 64;
+
+    uint32_t divrem_basecase(uint32_t *q, uint32_t *a, size_t an, uint32_t const *d, size_t dn) {
+        // Knuth's algorithm D, d[dn - 1] has the top bit set and dn >= 2
+        uint32_t top = 0;
+        if (cmp_n(a + an - dn, d, dn) >= 0) {
+            sub_n(a + an - dn, a + an - dn, d, dn);
+            top = 1;
+        }
+        uint64_t const BASE = uint64_t(1) << 32;
+        uint64_t const d1 = d[dn - 1], d0 = d[dn - 2];
+        for (size_t j = an - dn; j-- > 0;) {
+            // estimate from three leading digits is at most one too large
+            uint64_t num = (uint64_t(a[j + dn]) << 32) | a[j + dn - 1];
+            uint64_t qhat = num / d1, rhat = num % d1;
+            while (qhat >= BASE || qhat * d0 > ((rhat << 32) | a[j + dn - 2])) {
+                qhat--;
+                rhat += d1;
+                if (rhat >= BASE) {
+                    break;
+                }
+            }
+            uint32_t borrow = submul_1(a + j, d, dn, static_cast<uint32_t>(qhat));
+            if (a[j + dn] < borrow) {
+                qhat--;
+                add_n(a + j, a + j, d, dn);
+            }
+            a[j + dn] = 0;
+            q[j] = static_cast<uint32_t>(qhat);
+        }
+        return top;
+    }
+
+    namespace {
+        void div2n1n(uint32_t *q, uint32_t *a, uint32_t const *d, size_t n);
+
+        // Divides a[0..3n) by normalized d[0..2n), a[n..3n) < d.
+        // Writes q[0..n), leaves remainder in a[0..2n) and zero above.
+        void div3n2n(uint32_t *q, uint32_t *a, uint32_t const *d, size_t n) {
+            uint32_t const *d1 = d + n;
+            if (cmp_n(a + 2 * n, d1, n) < 0) {
+                div2n1n(q, a + n, d1, n);
+            } else {
+                // high halves are equal: q = BASE^n - 1, c = a[n..3n) - d1 * BASE^n + d1
+                std::fill(q, q + n, UINT32_MAX);
+                sub_n(a + 2 * n, a + 2 * n, d1, n);
+                add(a + n, a + n, 2 * n, d1, n);
+            }
+            // r = c * BASE^n + a[0..n) - q * d0, at most two corrections
+            std::vector<uint32_t> qd(2 * n);
+            mul(qd.data(), q, n, d, n);
+            uint32_t borrow = sub(a, a, 2 * n + 1, qd.data(), 2 * n);
+            while (borrow) {
+                sub_1(q, q, n, 1);
+                borrow -= add(a, a, 2 * n + 1, d, 2 * n);
+            }
+        }
+
+        // Divides a[0..2n) by normalized d[0..n), a[n..2n) < d.
+        // Writes q[0..n), leaves remainder in a[0..n) and zero above.
+        void div2n1n(uint32_t *q, uint32_t *a, uint32_t const *d, size_t n) {
+            if (n % 2 || n < bz_threshold) {
+                divrem_basecase(q, a, 2 * n, d, n);
+                return;
+            }
+            size_t half = n / 2;
+            div3n2n(q + half, a + half, d, half);
+            div3n2n(q, a, d, half);
+        }
+
+        // Division by normalized d[0..n) blockwise, n = m * 2^k with small m
+        void divrem_bz(uint32_t *q, uint32_t *a, size_t blocks, uint32_t const *d, size_t n) {
+            // the top block of a is less than d, each step brings down one more block
+            for (size_t i = blocks - 1; i-- > 0;) {
+                div2n1n(q + i * n, a + i * n, d, n);
+            }
+        }
+    }
+
+    void divrem(uint32_t *q, uint32_t *r, uint32_t const *a, size_t an, uint32_t const *d, size_t dn) {
+        if (dn == 1) {
+            r[0] = divrem_1(q, a, an, d[0]);
+            return;
+        }
+        unsigned bits = static_cast<unsigned>(__builtin_clz(d[dn - 1]));
+        size_t qn = an - dn + 1;
+        if (dn < bz_threshold || qn < bz_threshold) {
+            std::vector<uint32_t> na(an + 1), nd(dn);
+            if (bits) {
+                na[an] = lshift(na.data(), a, an, bits);
+                lshift(nd.data(), d, dn, bits);
+            } else {
+                std::copy(a, a + an, na.begin());
+                std::copy(d, d + dn, nd.begin());
+            }
+            divrem_basecase(q, na.data(), an + 1, nd.data(), dn);
+            if (bits) {
+                rshift(r, na.data(), dn, bits);
+            } else {
+                std::copy(na.begin(), na.begin() + dn, r);
+            }
+            return;
+        }
+        // pad divisor with low zero digits to n = m * 2^k, m < bz_threshold
+        size_t m = dn, k = 0;
+        while (m >= bz_threshold) {
+            m = (m + 1) / 2;
+            k++;
+        }
+        size_t n = m << k, shift = n - dn;
+        size_t blocks = (an + shift) / n + 1;
+        std::vector<uint32_t> na(blocks * n, 0), nd(n, 0);
+        if (bits) {
+            na[an + shift] = lshift(na.data() + shift, a, an, bits);
+            lshift(nd.data() + shift, d, dn, bits);
+        } else {
+            std::copy(a, a + an, na.begin() + shift);
+            std::copy(d, d + dn, nd.begin() + shift);
+        }
+        std::vector<uint32_t> nq((blocks - 1) * n);
+        divrem_bz(nq.data(), na.data(), blocks, nd.data(), n);
+        std::copy(nq.begin(), nq.begin() + qn, q);
+        if (bits) {
+            rshift(r, na.data() + shift, dn, bits);
+        } else {
+            std::copy(na.begin() + shift, na.begin() + n, r);
+        }
+    }
+}
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include "limb_ops.h"
+#include "limb_parallel.h"
+
+namespace limbs {
+    // Crossover points in digits of the shorter operand, see big_integer_benchmark.
+    size_t karatsuba_threshold = 32;
+    size_t toom3_threshold = 256;
+    size_t sqr_karatsuba_threshold = 112;
+
+    namespace {
+        // Signed number used by Toom-3 interpolation, where intermediate values may be negative.
+        struct snum {
+            std::vector<uint32_t> d;  // magnitude without leading zeros, empty for 0
+            bool neg = false;
+
+            snum() = default;
+
+            snum(uint32_t const *p, size_t n) : d(p, p + normalized_size(p, n)) {}
+
+            void normalize() {
+                d.resize(normalized_size(d.data(), d.size()));
+                if (d.empty()) {
+                    neg = false;
+                }
+            }
+        };
+
+        snum add_signed(snum const &x, snum const &y, bool y_neg) {
+            snum res;
+            if (x.neg == y_neg) {
+                auto const &g = x.d.size() >= y.d.size() ? x.d : y.d;
+                auto const &l = x.d.size() >= y.d.size() ? y.d : x.d;
+                res.d.resize(g.size() + 1);
+                res.d[g.size()] = add(res.d.data(), g.data(), g.size(), l.data(), l.size());
+                res.neg = x.neg;
+            } else if (cmp(x.d.data(), x.d.size(), y.d.data(), y.d.size()) >= 0) {
+                res.d.resize(x.d.size());
+                sub(res.d.data(), x.d.data(), x.d.size(), y.d.data(), y.d.size());
+                res.neg = x.neg;
+            } else {
+                res.d.resize(y.d.size());
+                sub(res.d.data(), y.d.data(), y.d.size(), x.d.data(), x.d.size());
+                res.neg = y_neg;
+            }
+            res.normalize();
+            return res;
+        }
+
+        snum operator+(snum const &x, snum const &y) {
+            return add_signed(x, y, y.neg);
+        }
+
+        snum operator-(snum const &x, snum const &y) {
+            return add_signed(x, y, !y.neg);
+        }
+
+        snum operator*(snum const &x, snum const &y) {
+            snum res;
+            if (x.d.empty() || y.d.empty()) {
+                return res;
+            }
+            res.d.resize(x.d.size() + y.d.size());
+            mul(res.d.data(), x.d.data(), x.d.size(), y.d.data(), y.d.size());
+            res.neg = x.neg != y.neg;
+            res.normalize();
+            return res;
+        }
+
+        void double_up(snum &x) {
+            x.d.push_back(0);
+            lshift(x.d.data(), x.d.data(), x.d.size(), 1);
+            x.normalize();
+        }
+
+        void halve_exact(snum &x) {
+            rshift(x.d.data(), x.d.data(), x.d.size(), 1);
+            x.normalize();
+        }
+
+        void third_exact(snum &x) {
+            divrem_1(x.d.data(), x.d.data(), x.d.size(), 3);
+            x.normalize();
+        }
+
+        // Adds non-negative x * BASE^offset to r[0..rn)
+        void add_at(uint32_t *r, size_t rn, size_t offset, snum const &x) {
+            assert(!x.neg && offset + x.d.size() <= rn);
+            add(r + offset, r + offset, rn - offset, x.d.data(), x.d.size());
+        }
+
+        // Operands of too different lengths: split the longer one into chunks of bn digits.
+        void mul_unbalanced(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+            std::fill(r, r + an + bn, 0);
+            if (parallel_mul(bn)) {
+                // even chunks go straight to r and odd ones to a second sum, so that
+                // no two chunks of the same sum overlap and all of them are independent
+                std::vector<uint32_t> odd(an + bn, 0);
+                task_group tasks;
+                for (size_t i = 0; i < an; i += bn) {
+                    uint32_t *to = (i / bn % 2 ? odd.data() : r) + i;
+                    tasks.run([=] { mul(to, a + i, std::min(bn, an - i), b, bn); });
+                }
+                tasks.wait();
+                add(r, r, an + bn, odd.data(), an + bn);
+                return;
+            }
+            std::vector<uint32_t> tmp(2 * bn);
+            for (size_t i = 0; i < an; i += bn) {
+                size_t len = std::min(bn, an - i);
+                mul(tmp.data(), a + i, len, b, bn);
+                add(r + i, r + i, an + bn - i, tmp.data(), len + bn);
+            }
+        }
+    }
+
+    void mul(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (bn == 0) {
+            std::fill(r, r + an, 0);
+        } else if (bn < karatsuba_threshold) {
+            mul_basecase(r, a, an, b, bn);
+        } else if (bn < toom3_threshold) {
+            mul_karatsuba(r, a, an, b, bn);
+        } else if (bn >= ntt_threshold && an + bn <= ntt_max_size) {
+            mul_ntt(r, a, an, b, bn);
+        } else {
+            mul_toom3(r, a, an, b, bn);
+        }
+    }
+
+    void mul_basecase(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        if (bn == 0) {
+            std::fill(r, r + an, 0);
+            return;
+        }
+        r[an] = mul_1(r, a, an, b[0]);
+        for (size_t j = 1; j < bn; j++) {
+            r[an + j] = addmul_1(r + j, a, an, b[j]);
+        }
+    }
+
+    void mul_karatsuba(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        size_t m = (an + 1) / 2;
+        if (bn <= m) {
+            mul_unbalanced(r, a, an, b, bn);
+            return;
+        }
+        // a = a1 * BASE^m + a0, b = b1 * BASE^m + b0
+        size_t a1n = an - m, b1n = bn - m;
+        task_group tasks(parallel_mul(m));
+        tasks.run([=] { mul(r, a, m, b, m); });
+        tasks.run([=] { mul(r + 2 * m, a + m, a1n, b + m, b1n); });
+
+        // (a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1
+        std::vector<uint32_t> tmp(4 * m + 4);
+        uint32_t *sa = tmp.data(), *sb = sa + m + 1, *mid = sb + m + 1;
+        sa[m] = add(sa, a, m, a + m, a1n);
+        sb[m] = add(sb, b, m, b + m, b1n);
+        size_t san = normalized_size(sa, m + 1), sbn = normalized_size(sb, m + 1);
+        std::fill(mid + san + sbn, mid + 2 * m + 2, 0);
+        mul(mid, sa, san, sb, sbn);
+        tasks.wait();
+        sub(mid, mid, 2 * m + 2, r, 2 * m);
+        sub(mid, mid, 2 * m + 2, r + 2 * m, a1n + b1n);
+        add(r + m, r + m, an + bn - m, mid, normalized_size(mid, 2 * m + 2));
+    }
+
+    void sqr_basecase(uint32_t *r, uint32_t const *a, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        // cross products a[i] * a[j], i < j: row i starts at r[2i + 1]
+        r[0] = 0;
+        r[2 * n - 1] = 0;
+        if (n > 1) {
+            r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+            for (size_t i = 1; i + 1 < n; i++) {
+                r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+            }
+            lshift(r, r, 2 * n, 1);
+        }
+        // plus the squares on the diagonal
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t sq = uint64_t(a[i]) * a[i];
+            carry += uint64_t(r[2 * i]) + static_cast<uint32_t>(sq);
+            r[2 * i] = static_cast<uint32_t>(carry);
+            carry = (carry >> 32) + r[2 * i + 1] + (sq >> 32);
+            r[2 * i + 1] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    void sqr(uint32_t *r, uint32_t const *a, size_t n) {
+        if (n < std::max<size_t>(sqr_karatsuba_threshold, 2)) {
+            sqr_basecase(r, a, n);
+            return;
+        }
+        if (n >= toom3_threshold) {
+            mul(r, a, n, a, n);
+            return;
+        }
+        // a = a1 * BASE^m + a0: (a0 + a1)^2 - a0^2 - a1^2 is the middle part
+        size_t m = (n + 1) / 2, h = n - m;
+        sqr(r, a, m);
+        sqr(r + 2 * m, a + m, h);
+        std::vector<uint32_t> tmp(3 * m + 3);
+        uint32_t *s = tmp.data(), *mid = s + m + 1;
+        s[m] = add(s, a, m, a + m, h);
+        size_t sn = normalized_size(s, m + 1);
+        std::fill(mid + 2 * sn, mid + 2 * m + 2, 0);
+        sqr(mid, s, sn);
+        sub(mid, mid, 2 * m + 2, r, 2 * m);
+        sub(mid, mid, 2 * m + 2, r + 2 * m, 2 * h);
+        add(r + m, r + m, 2 * n - m, mid, normalized_size(mid, 2 * m + 2));
+    }
+
+    namespace {
+        // the middle product has m + 1 digits, below 4 digits it would not be shorter than n
+        bool mul_n_basecase(size_t n) {
+            return n < std::max<size_t>(karatsuba_threshold, 4);
+        }
+    }
+
+    size_t mul_n_scratch(size_t n) {
+        size_t res = 0;
+        while (!mul_n_basecase(n)) {
+            size_t m = (n + 1) / 2;
+            res += 4 * m + 4;
+            n = m + 1;
+        }
+        return res;
+    }
+
+    void mul_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t *ws) {
+        if (mul_n_basecase(n)) {
+            mul_basecase(r, a, n, b, n);
+            return;
+        }
+        // a = a1 * BASE^m + a0, b = b1 * BASE^m + b0, the high parts have h <= m digits
+        size_t m = (n + 1) / 2, h = n - m;
+        uint32_t *sa = ws, *sb = sa + m + 1, *mid = sb + m + 1, *rest = mid + 2 * m + 2;
+        mul_n(r, a, b, m, rest);
+        mul_n(r + 2 * m, a + m, b + m, h, rest);
+        sa[m] = add(sa, a, m, a + m, h);
+        sb[m] = add(sb, b, m, b + m, h);
+        mul_n(mid, sa, sb, m + 1, rest);
+        sub(mid, mid, 2 * m + 2, r, 2 * m);
+        sub(mid, mid, 2 * m + 2, r + 2 * m, 2 * h);
+        add(r + m, r + m, 2 * n - m, mid, normalized_size(mid, 2 * m + 2));
+    }
+
+    void mul_toom3(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        size_t k = (an + 2) / 3;
+        if (bn <= 2 * k) {
+            mul_karatsuba(r, a, an, b, bn);
+            return;
+        }
+        // Evaluation at 0, 1, -1, -2 and infinity
+        snum a0(a, k), a1(a + k, k), a2(a + 2 * k, an - 2 * k);
+        snum b0(b, k), b1(b + k, k), b2(b + 2 * k, bn - 2 * k);
+        auto evaluate = [](snum const &x0, snum const &x1, snum const &x2, snum &p1, snum &pm1, snum &pm2) {
+            snum t = x0 + x2;
+            p1 = t + x1;
+            pm1 = t - x1;
+            pm2 = pm1 + x2;
+            double_up(pm2);
+            pm2 = pm2 - x0;
+        };
+        snum pa1, pam1, pam2, pb1, pbm1, pbm2;
+        evaluate(a0, a1, a2, pa1, pam1, pam2);
+        evaluate(b0, b1, b2, pb1, pbm1, pbm2);
+
+        snum v0, v1, vm1, vm2, vinf;
+        task_group tasks(parallel_mul(k));
+        tasks.run([&] { v0 = a0 * b0; });
+        tasks.run([&] { v1 = pa1 * pb1; });
+        tasks.run([&] { vm1 = pam1 * pbm1; });
+        tasks.run([&] { vm2 = pam2 * pbm2; });
+        vinf = a2 * b2;
+        tasks.wait();
+
+        // Interpolation (Bodrato's sequence)
+        snum r3 = vm2 - v1;
+        third_exact(r3);
+        snum r1 = v1 - vm1;
+        halve_exact(r1);
+        snum r2 = vm1 - v0;
+        r3 = r2 - r3;
+        halve_exact(r3);
+        r3 = r3 + vinf + vinf;
+        r2 = r2 + r1 - vinf;
+        r1 = r1 - r3;
+
+        size_t rn = an + bn;
+        std::fill(r, r + rn, 0);
+        std::copy(v0.d.begin(), v0.d.end(), r);
+        std::copy(vinf.d.begin(), vinf.d.end(), r + 4 * k);
+        add_at(r, rn, k, r1);
+        add_at(r, rn, 2 * k, r2);
+        add_at(r, rn, 3 * k, r3);
+    }
+}
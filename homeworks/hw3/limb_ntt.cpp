@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <vector>
+#include "limb_ops.h"
+#include "limb_parallel.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+namespace limbs {
+    size_t ntt_threshold = 3072;
+
+    namespace {
+        // Number theoretic transform modulo prime MOD = c * 2^k + 1 with primitive root ROOT.
+        // All three primes are below 2^31, so a sum of two residues fits into uint32_t.
+        // Butterflies use Montgomery multiplication with R = 2^32: twiddle factors are kept
+        // in Montgomery form, so that mont_mul(x, w) = x * w and data stays in normal form.
+        template<uint32_t MOD, uint32_t ROOT>
+        struct ntt_prime {
+            static const uint32_t mod = MOD;
+
+            // -MOD^(-1) mod 2^32 by Newton's iteration
+            static constexpr uint32_t neg_inv() {
+                uint32_t inv = MOD;
+                for (int i = 0; i < 4; i++) {
+                    inv *= 2 - MOD * inv;
+                }
+                return 0u - inv;
+            }
+
+            static const uint32_t NEG_INV = neg_inv();
+
+            static uint32_t mul(uint32_t a, uint32_t b) {
+                return static_cast<uint32_t>(uint64_t(a) * b % MOD);
+            }
+
+            static uint32_t mont_mul(uint32_t a, uint32_t b) {
+                uint64_t t = uint64_t(a) * b;
+                uint32_t m = static_cast<uint32_t>(t) * NEG_INV;
+                auto u = static_cast<uint32_t>((t + uint64_t(m) * MOD) >> 32);
+                return std::min(u, u - MOD);
+            }
+
+            static uint32_t to_mont(uint32_t a) {
+                return static_cast<uint32_t>((uint64_t(a) << 32) % MOD);
+            }
+
+            static uint32_t pow(uint32_t a, uint64_t e) {
+                uint32_t res = 1;
+                for (; e; e >>= 1) {
+                    if (e & 1) {
+                        res = mul(res, a);
+                    }
+                    a = mul(a, a);
+                }
+                return res;
+            }
+
+            static uint32_t inverse(uint32_t a) {
+                return pow(a, MOD - 2);
+            }
+
+            // Transform without the final division by n for the inverse one.
+            // Butterflies of a level are independent, large levels are split between threads.
+            static void transform(std::vector<uint32_t> &a, bool invert) {
+                size_t n = a.size();
+                size_t bits = static_cast<size_t>(__builtin_ctzll(n));
+                parallel_for(n, parallel_mul_threshold, [&a, n, bits](size_t begin, size_t end) {
+                    // j is i with reversed bits, kept up to date by a reversed increment
+                    size_t j = 0;
+                    for (size_t b = 0; b < bits; b++) {
+                        j |= ((begin >> b) & 1) << (bits - 1 - b);
+                    }
+                    for (size_t i = begin; i < end; i++) {
+                        if (i < j) {
+                            std::swap(a[i], a[j]);
+                        }
+                        size_t bit = n >> 1;
+                        for (; j & bit; bit >>= 1) {
+                            j ^= bit;
+                        }
+                        j ^= bit;
+                    }
+                });
+                std::vector<uint32_t> w(n / 2);
+                for (size_t len = 2; len <= n; len <<= 1) {
+                    uint32_t w_len = pow(ROOT, (MOD - 1) / len);
+                    if (invert) {
+                        w_len = inverse(w_len);
+                    }
+                    size_t half = len / 2;
+                    uint32_t w_len_mont = to_mont(w_len);
+                    parallel_for(half, parallel_mul_threshold, [&w, w_len, w_len_mont](size_t begin, size_t end) {
+                        w[begin] = to_mont(pow(w_len, begin));
+                        for (size_t j = begin + 1; j < end; j++) {
+                            w[j] = mont_mul(w[j - 1], w_len_mont);
+                        }
+                    });
+                    // butterfly t pairs a[i + j] and a[i + j + half], i = t / half * len, j = t % half
+                    parallel_for(n / 2, parallel_mul_threshold, [&a, &w, len, half](size_t begin, size_t end) {
+                        size_t block = begin / half, j = begin % half;
+                        for (size_t t = begin; t < end; block++, j = 0) {
+                            size_t stop = std::min(half, j + (end - t));
+                            t += stop - j;
+                            uint32_t *lo = a.data() + block * len, *hi = lo + half;
+                            for (; j < stop; j++) {
+                                uint32_t u = lo[j], v = mont_mul(hi[j], w[j]);
+                                uint32_t s = u + v, d = u + MOD - v;
+                                // unsigned minimum instead of a branch on the reduction
+                                lo[j] = std::min(s, s - MOD);
+                                hi[j] = std::min(d, d - MOD);
+                            }
+                        }
+                    });
+                }
+            }
+
+            // Cyclic convolution of a and b of length n modulo MOD
+            static std::vector<uint32_t> convolution(uint32_t const *a, size_t an, uint32_t const *b, size_t bn,
+                                                     size_t n) {
+                std::vector<uint32_t> fa(n, 0), fb(n, 0);
+                for (size_t i = 0; i < an; i++) {
+                    fa[i] = a[i] % MOD;
+                }
+                for (size_t i = 0; i < bn; i++) {
+                    fb[i] = b[i] % MOD;
+                }
+                {
+                    task_group tasks(parallel_mul(bn));
+                    tasks.run([&fa] { transform(fa, false); });
+                    transform(fb, false);
+                    tasks.wait();
+                }
+                // pointwise products lose a factor of R, the scaling by R^2 / n restores it
+                uint32_t scale = to_mont(to_mont(inverse(static_cast<uint32_t>(n % MOD))));
+                for (size_t i = 0; i < n; i++) {
+                    fa[i] = mont_mul(fa[i], fb[i]);
+                }
+                transform(fa, true);
+                for (auto &x : fa) {
+                    x = mont_mul(x, scale);
+                }
+                return fa;
+            }
+        };
+
+        typedef ntt_prime<2113929217u, 5> prime1;   // 63 * 2^25 + 1
+        typedef ntt_prime<2013265921u, 31> prime2;  // 15 * 2^27 + 1
+        typedef ntt_prime<1811939329u, 13> prime3;  // 27 * 2^26 + 1
+    }
+
+    // The shortest 2-adic order among the primes bounds the transform length
+    size_t const ntt_max_size = size_t(1) << 25;
+
+    void mul_ntt(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        size_t rn = an + bn;
+        if (an == 0 || bn == 0) {
+            std::fill(r, r + rn, 0);
+            return;
+        }
+        size_t n = 1;
+        while (n < rn - 1) {
+            n <<= 1;
+        }
+        // Each coefficient is below min(an, bn) * 2^64 < p1 * p2 * p3, so CRT restores it exactly
+        std::vector<uint32_t> c1, c2, c3;
+        {
+            task_group tasks(parallel_mul(std::min(an, bn)));
+            tasks.run([&] { c1 = prime1::convolution(a, an, b, bn, n); });
+            tasks.run([&] { c2 = prime2::convolution(a, an, b, bn, n); });
+            c3 = prime3::convolution(a, an, b, bn, n);
+            tasks.wait();
+        }
+
+        // Garner's algorithm: x = x1 + x2 * p1 + x3 * p1 * p2
+        uint32_t const p1 = prime1::mod, p2 = prime2::mod;
+        uint32_t const p1_inv_p2 = prime2::inverse(p1 % prime2::mod);
+        uint32_t const p1_inv_p3 = prime3::inverse(p1 % prime3::mod);
+        uint32_t const p2_inv_p3 = prime3::inverse(p2 % prime3::mod);
+        // Chunks start with no carry, the one left over by a chunk is added to the next one afterwards
+        size_t chunks = std::max<size_t>(1, std::min(mul_threads(), rn / std::max<size_t>(parallel_mul_threshold, 1)));
+        std::vector<uint128_t> carries(chunks);
+        parallel_for(chunks, 1, [&](size_t first, size_t last) {
+            for (size_t c = first; c < last; c++) {
+                uint128_t carry = 0;
+                for (size_t i = rn * c / chunks; i < rn * (c + 1) / chunks; i++) {
+                    if (i < rn - 1) {
+                        uint32_t x1 = c1[i];
+                        uint32_t x2 = prime2::mul(c2[i] + prime2::mod - x1 % prime2::mod, p1_inv_p2);
+                        uint32_t t = prime3::mul(c3[i] + prime3::mod - x1 % prime3::mod, p1_inv_p3);
+                        uint32_t x3 = prime3::mul(t + prime3::mod - x2 % prime3::mod, p2_inv_p3);
+                        carry += x1 + uint128_t(x2) * p1 + uint128_t(x3) * p1 * p2;
+                    }
+                    r[i] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                carries[c] = carry;
+            }
+        });
+        for (size_t c = 1; c < chunks; c++) {
+            uint128_t carry = carries[c - 1];
+            for (size_t i = rn * c / chunks; carry && i < rn; i++) {
+                carry += r[i];
+                r[i] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+        }
+    }
+}
@@ -0,0 +1,179 @@
+#include "limb_ops.h"
+
+#ifdef BIG_INTEGER_ASM
+// limb_asm.S
+extern "C" {
+uint32_t limbs_asm_add_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+uint32_t limbs_asm_sub_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+uint32_t limbs_asm_mul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+uint32_t limbs_asm_addmul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+uint32_t limbs_asm_submul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+}
+#endif
+
+namespace limbs {
+    uint32_t add_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n) {
+#ifdef BIG_INTEGER_ASM
+        return limbs_asm_add_n(r, a, b, n);
+#else
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += uint64_t(a[i]) + b[i];
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return static_cast<uint32_t>(carry);
+#endif
+    }
+
+    uint32_t add(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        uint32_t carry = add_n(r, a, b, bn);
+        return add_1(r + bn, a + bn, an - bn, carry);
+    }
+
+    uint32_t add_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x) {
+        size_t i = 0;
+        for (; i < n && x; i++) {
+            uint32_t s = a[i] + x;
+            x = s < x ? 1 : 0;
+            r[i] = s;
+        }
+        if (r != a) {
+            for (; i < n; i++) {
+                r[i] = a[i];
+            }
+        }
+        return x;
+    }
+
+    uint32_t sub_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n) {
+#ifdef BIG_INTEGER_ASM
+        return limbs_asm_sub_n(r, a, b, n);
+#else
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t diff = uint64_t(a[i]) - b[i] - borrow;
+            r[i] = static_cast<uint32_t>(diff);
+            borrow = static_cast<uint32_t>(diff >> 63);
+        }
+        return borrow;
+#endif
+    }
+
+    uint32_t sub(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        uint32_t borrow = sub_n(r, a, b, bn);
+        return sub_1(r + bn, a + bn, an - bn, borrow);
+    }
+
+    uint32_t sub_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x) {
+        size_t i = 0;
+        for (; i < n && x; i++) {
+            uint32_t d = a[i] - x;
+            x = a[i] < x ? 1 : 0;
+            r[i] = d;
+        }
+        if (r != a) {
+            for (; i < n; i++) {
+                r[i] = a[i];
+            }
+        }
+        return x;
+    }
+
+    uint32_t mul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x) {
+#ifdef BIG_INTEGER_ASM
+        return limbs_asm_mul_1(r, a, n, x);
+#else
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += uint64_t(a[i]) * x;
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return static_cast<uint32_t>(carry);
+#endif
+    }
+
+    uint32_t addmul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x) {
+#ifdef BIG_INTEGER_ASM
+        return limbs_asm_addmul_1(r, a, n, x);
+#else
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            // (2^32 - 1)^2 + 2 * (2^32 - 1) fits into 64 bits
+            carry += uint64_t(a[i]) * x + r[i];
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return static_cast<uint32_t>(carry);
+#endif
+    }
+
+    uint32_t submul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x) {
+#ifdef BIG_INTEGER_ASM
+        return limbs_asm_submul_1(r, a, n, x);
+#else
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += uint64_t(a[i]) * x;
+            auto low = static_cast<uint32_t>(carry);
+            carry >>= 32;
+            carry += r[i] < low ? 1 : 0;
+            r[i] -= low;
+        }
+        return static_cast<uint32_t>(carry);
+#endif
+    }
+
+    uint32_t divrem_1(uint32_t *q, uint32_t const *a, size_t n, uint32_t x) {
+        uint64_t rem = 0;
+        for (size_t i = n; i-- > 0;) {
+            uint64_t cur = (rem << 32) | a[i];
+            q[i] = static_cast<uint32_t>(cur / x);
+            rem = cur % x;
+        }
+        return static_cast<uint32_t>(rem);
+    }
+
+    uint32_t lshift(uint32_t *r, uint32_t const *a, size_t n, unsigned cnt) {
+        // goes from the top so that r may be shifted up relative to a
+        uint32_t out = 0;
+        if (n == 0) {
+            return out;
+        }
+        out = a[n - 1] >> (32 - cnt);
+        for (size_t i = n - 1; i > 0; i--) {
+            r[i] = (a[i] << cnt) | (a[i - 1] >> (32 - cnt));
+        }
+        r[0] = a[0] << cnt;
+        return out;
+    }
+
+    uint32_t rshift(uint32_t *r, uint32_t const *a, size_t n, unsigned cnt) {
+        // goes from the bottom so that r may be shifted down relative to a
+        uint32_t out = 0;
+        if (n == 0) {
+            return out;
+        }
+        out = a[0] << (32 - cnt);
+        for (size_t i = 0; i + 1 < n; i++) {
+            r[i] = (a[i] >> cnt) | (a[i + 1] << (32 - cnt));
+        }
+        r[n - 1] = a[n - 1] >> cnt;
+        return out;
+    }
+
+    int cmp(uint32_t const *a, size_t an, uint32_t const *b, size_t bn) {
+        if (an != bn) {
+            return an < bn ? -1 : 1;
+        }
+        return cmp_n(a, b, an);
+    }
+
+    size_t normalized_size(uint32_t const *a, size_t n) {
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef BIGINT_HW3_LIMB_OPS_H
+#define BIGINT_HW3_LIMB_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernels over raw little-endian sequences of 32-bit digits (limbs).
+// Result may alias an operand only when both start at the same address,
+// except for multiplication, where the result must not overlap operands.
+namespace limbs {
+    // r[0..n) = a[0..n) + b[0..n), returns carry
+    uint32_t add_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+
+    // r[0..an) = a[0..an) + b[0..bn), an >= bn, returns carry
+    uint32_t add(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // r[0..n) = a[0..n) + x, returns carry
+    uint32_t add_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+    // r[0..n) = a[0..n) - b[0..n), returns borrow
+    uint32_t sub_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+
+    // r[0..an) = a[0..an) - b[0..bn), an >= bn, returns borrow
+    uint32_t sub(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // r[0..n) = a[0..n) - x, returns borrow
+    uint32_t sub_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+    // r[0..n) = a[0..n) * x, returns high digit
+    uint32_t mul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+    // r[0..n) += a[0..n) * x, returns high digit
+    uint32_t addmul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+    // r[0..n) -= a[0..n) * x, returns high borrow digit
+    uint32_t submul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+    // q[0..n) = a[0..n) / x, returns remainder; q may alias a
+    uint32_t divrem_1(uint32_t *q, uint32_t const *a, size_t n, uint32_t x);
+
+    // r[0..n) = a[0..n) << cnt, 0 < cnt < 32, returns shifted out bits; r may be above a
+    uint32_t lshift(uint32_t *r, uint32_t const *a, size_t n, unsigned cnt);
+
+    // r[0..n) = a[0..n) >> cnt, 0 < cnt < 32, returns shifted out bits (in high part); r may be below a
+    uint32_t rshift(uint32_t *r, uint32_t const *a, size_t n, unsigned cnt);
+
+    // three-way comparison of two sequences of equal length, vectorized in limb_simd.cpp
+    int cmp_n(uint32_t const *a, uint32_t const *b, size_t n);
+
+    // three-way comparison of two normalized sequences
+    int cmp(uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // length without leading zero digits
+    size_t normalized_size(uint32_t const *a, size_t n);
+
+    // r[i] = ((a[i] ^ ma) op (b[i] ^ mb)) ^ mr for i in [0..n), masks are 0 or UINT32_MAX,
+    // so any operand or the result may be complemented; vectorized in limb_simd.cpp
+    void and_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr);
+    void or_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr);
+    void xor_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr);
+
+    // Multiplication engine: r[0..an + bn) = a * b.
+    // Schoolbook below karatsuba_threshold digits of the shorter operand,
+    // Karatsuba below toom3_threshold, Toom-3 below ntt_threshold, NTT above
+    // as long as the product is not longer than ntt_max_size.
+    extern size_t karatsuba_threshold;
+    extern size_t toom3_threshold;
+    extern size_t ntt_threshold;
+    extern size_t const ntt_max_size;
+
+    void mul(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // Parallel multiplication, off by default. With threads > 1 the sub-products of Karatsuba
+    // and Toom-3, the chunks of unbalanced products and the transforms of NTT run as tasks
+    // on threads - 1 pool workers and the calling thread, as long as the shorter operand
+    // of the product being split has at least parallel_mul_threshold digits.
+    // Neither may be changed while a multiplication runs.
+    void set_mul_threads(size_t threads);
+
+    size_t mul_threads();
+
+    extern size_t parallel_mul_threshold;
+
+    // Top levels of each algorithm, recursive calls go through mul().
+    void mul_basecase(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    void mul_karatsuba(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    void mul_toom3(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // Squaring: r[0..2n) = a[0..n)^2. Each cross product a[i] * a[j] is taken once below
+    // sqr_karatsuba_threshold digits, three half-size squares up to toom3_threshold, mul() above.
+    extern size_t sqr_karatsuba_threshold;
+
+    void sqr(uint32_t *r, uint32_t const *a, size_t n);
+
+    void sqr_basecase(uint32_t *r, uint32_t const *a, size_t n);
+
+    // r[0..2n) = a[0..n) * b[0..n) by Karatsuba down to karatsuba_threshold,
+    // temporaries in ws[0..mul_n_scratch(n)) instead of the heap
+    void mul_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t *ws);
+
+    size_t mul_n_scratch(size_t n);
+
+    // Three-prime NTT with CRT recombination, an + bn <= ntt_max_size
+    void mul_ntt(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+
+    // Division engine: q[0..an - dn + 1) = a / d, r[0..dn) = a % d, an >= dn, d[dn - 1] != 0.
+    // Knuth's algorithm D when the divisor or the quotient is shorter than bz_threshold,
+    // recursive Burnikel-Ziegler division on top of mul() otherwise.
+    extern size_t bz_threshold;
+
+    void divrem(uint32_t *q, uint32_t *r, uint32_t const *a, size_t an, uint32_t const *d, size_t dn);
+
+    // Knuth's algorithm D in place: d is normalized (top bit set), dn >= 2.
+    // Writes q[0..an - dn), leaves remainder in a[0..dn), returns the top quotient digit.
+    uint32_t divrem_basecase(uint32_t *q, uint32_t *a, size_t an, uint32_t const *d, size_t dn);
+}
+
+#endif //BIGINT_HW3_LIMB_OPS_H
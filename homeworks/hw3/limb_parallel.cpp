@@ -0,0 +1,131 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "limb_parallel.h"
+
+namespace limbs {
+    size_t parallel_mul_threshold = 4096;
+
+    struct task_pool {
+        struct task {
+            std::function<void()> f;
+            task_group *group;
+        };
+
+        std::mutex lock;
+        // signalled on a new task, a finished group and on shutdown
+        std::condition_variable changed;
+        std::deque<task> queue;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        static task_pool &instance() {
+            static task_pool pool;
+            return pool;
+        }
+
+        ~task_pool() {
+            resize(0);
+        }
+
+        void resize(size_t n) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            changed.notify_all();
+            for (auto &w : workers) {
+                w.join();
+            }
+            workers.clear();
+            stopping = false;
+            for (size_t i = 0; i < n; i++) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+
+        void work() {
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                changed.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                run_front(guard);
+            }
+        }
+
+        // runs the oldest task with the lock released, guard is locked before and after
+        void run_front(std::unique_lock<std::mutex> &guard) {
+            task t = std::move(queue.front());
+            queue.pop_front();
+            guard.unlock();
+            std::exception_ptr error;
+            try {
+                t.f();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            guard.lock();
+            if (error && !t.group->error) {
+                t.group->error = error;
+            }
+            if (--t.group->pending == 0) {
+                changed.notify_all();
+            }
+        }
+    };
+
+    void set_mul_threads(size_t threads) {
+        task_pool::instance().resize(threads > 1 ? threads - 1 : 0);
+    }
+
+    size_t mul_threads() {
+        return task_pool::instance().workers.size() + 1;
+    }
+
+    bool parallel_mul(size_t n) {
+        return n >= parallel_mul_threshold && !task_pool::instance().workers.empty();
+    }
+
+    task_group::task_group(bool parallel) : parallel(parallel && mul_threads() > 1), pending(0) {}
+
+    task_group::~task_group() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    void task_group::submit(std::function<void()> f) {
+        task_pool &pool = task_pool::instance();
+        {
+            std::lock_guard<std::mutex> guard(pool.lock);
+            pending++;
+            pool.queue.push_back({std::move(f), this});
+        }
+        pool.changed.notify_one();
+    }
+
+    void task_group::wait() {
+        if (!parallel) {
+            return;
+        }
+        task_pool &pool = task_pool::instance();
+        std::unique_lock<std::mutex> guard(pool.lock);
+        while (pending) {
+            if (!pool.queue.empty()) {
+                pool.run_front(guard);
+            } else {
+                pool.changed.wait(guard);
+            }
+        }
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+}
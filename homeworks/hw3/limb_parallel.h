@@ -0,0 +1,69 @@
+#ifndef BIGINT_HW3_LIMB_PARALLEL_H
+#define BIGINT_HW3_LIMB_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include "limb_ops.h"
+
+// Fork-join over the pool of worker threads started by limbs::set_mul_threads.
+// A thread waiting for its group runs queued tasks itself, so groups may nest freely.
+namespace limbs {
+    struct task_pool;
+
+    struct task_group {
+        // a group that is not parallel runs each task right away on the calling thread
+        explicit task_group(bool parallel = true);
+
+        // waits for the tasks still running, their exceptions are dropped
+        ~task_group();
+
+        task_group(task_group const &) = delete;
+
+        task_group &operator=(task_group const &) = delete;
+
+        template<typename F>
+        void run(F f) {
+            if (parallel) {
+                submit(std::function<void()>(std::move(f)));
+            } else {
+                f();
+            }
+        }
+
+        // waits for every task of the group, rethrows the first exception thrown by one of them
+        void wait();
+
+    private:
+        friend struct task_pool;
+
+        void submit(std::function<void()> f);
+
+        bool parallel;
+        size_t pending;
+        std::exception_ptr error;
+    };
+
+    // whether a product with a shorter operand of n digits splits into tasks
+    bool parallel_mul(size_t n);
+
+    // f(begin, end) over chunks of [0, n) no shorter than grain, one chunk per thread at most
+    template<typename F>
+    void parallel_for(size_t n, size_t grain, F const &f) {
+        size_t chunks = std::min(mul_threads(), n / std::max<size_t>(grain, 1));
+        if (chunks <= 1) {
+            f(size_t(0), n);
+            return;
+        }
+        task_group tasks;
+        for (size_t c = 1; c < chunks; c++) {
+            size_t begin = n * c / chunks, end = n * (c + 1) / chunks;
+            tasks.run([&f, begin, end] { f(begin, end); });
+        }
+        f(size_t(0), n / chunks);
+        tasks.wait();
+    }
+}
+
+#endif //BIGINT_HW3_LIMB_PARALLEL_H
@@ -0,0 +1,212 @@
+#include "limb_ops.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Comparison and bitwise kernels for AVX2 and AVX-512, chosen at run time.
+// The vector code is compiled with target attributes, so no -mavx flags are needed
+// and the binary still runs on processors without these extensions.
+// Other architectures get the scalar loops only.
+namespace limbs {
+    namespace {
+        // Complement masks are 0 or all ones, so ~(x ^ m) never needs a separate case
+        template<typename Op>
+        void bitwise_scalar(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                            uint32_t ma, uint32_t mb, uint32_t mr, Op op) {
+            for (size_t i = 0; i < n; i++) {
+                r[i] = op(a[i] ^ ma, b[i] ^ mb) ^ mr;
+            }
+        }
+
+        int cmp_scalar(uint32_t const *a, uint32_t const *b, size_t n) {
+            for (size_t i = n; i-- > 0;) {
+                if (a[i] != b[i]) {
+                    return a[i] < b[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        struct and_op {
+            uint32_t operator()(uint32_t x, uint32_t y) const { return x & y; }
+        };
+
+        struct or_op {
+            uint32_t operator()(uint32_t x, uint32_t y) const { return x | y; }
+        };
+
+        struct xor_op {
+            uint32_t operator()(uint32_t x, uint32_t y) const { return x ^ y; }
+        };
+
+        typedef void (*bitwise_kernel)(uint32_t *, uint32_t const *, uint32_t const *, size_t,
+                                       uint32_t, uint32_t, uint32_t);
+
+        template<typename Op>
+        void and_or_xor_scalar(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                               uint32_t ma, uint32_t mb, uint32_t mr) {
+            bitwise_scalar(r, a, b, n, ma, mb, mr, Op());
+        }
+
+        struct simd_kernels {
+            int (*cmp_n)(uint32_t const *, uint32_t const *, size_t);
+            bitwise_kernel and_n, or_n, xor_n;
+        };
+
+#if defined(__x86_64__) || defined(__i386__)
+        // add the vector overloads; the scalar operator() handles the tails
+        struct and_simd : and_op {
+            using and_op::operator();
+
+            __attribute__((target("avx2"))) __m256i operator()(__m256i x, __m256i y) const {
+                return _mm256_and_si256(x, y);
+            }
+
+            __attribute__((target("avx512f"))) __m512i operator()(__m512i x, __m512i y) const {
+                return _mm512_and_si512(x, y);
+            }
+        };
+
+        struct or_simd : or_op {
+            using or_op::operator();
+
+            __attribute__((target("avx2"))) __m256i operator()(__m256i x, __m256i y) const {
+                return _mm256_or_si256(x, y);
+            }
+
+            __attribute__((target("avx512f"))) __m512i operator()(__m512i x, __m512i y) const {
+                return _mm512_or_si512(x, y);
+            }
+        };
+
+        struct xor_simd : xor_op {
+            using xor_op::operator();
+
+            __attribute__((target("avx2"))) __m256i operator()(__m256i x, __m256i y) const {
+                return _mm256_xor_si256(x, y);
+            }
+
+            __attribute__((target("avx512f"))) __m512i operator()(__m512i x, __m512i y) const {
+                return _mm512_xor_si512(x, y);
+            }
+        };
+
+        // AVX2: 8 digits per step, the highest unequal lane decides
+        __attribute__((target("avx2")))
+        int cmp_avx2(uint32_t const *a, uint32_t const *b, size_t n) {
+            size_t i = n;
+            while (i >= 8) {
+                i -= 8;
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+                auto eq = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y))));
+                if (eq != 0xff) {
+                    size_t lane = i + 31 - static_cast<unsigned>(__builtin_clz(~eq & 0xff));
+                    return a[lane] < b[lane] ? -1 : 1;
+                }
+            }
+            return cmp_scalar(a, b, i);
+        }
+
+        template<typename Op>
+        __attribute__((target("avx2")))
+        void bitwise_avx2(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                          uint32_t ma, uint32_t mb, uint32_t mr, Op op) {
+            __m256i va = _mm256_set1_epi32(static_cast<int>(ma));
+            __m256i vb = _mm256_set1_epi32(static_cast<int>(mb));
+            __m256i vr = _mm256_set1_epi32(static_cast<int>(mr));
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i)), va);
+                __m256i y = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i)), vb);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_xor_si256(op(x, y), vr));
+            }
+            bitwise_scalar(r + i, a + i, b + i, n - i, ma, mb, mr, op);
+        }
+
+        // AVX-512: 16 digits per step, comparisons give a lane mask directly
+        __attribute__((target("avx512f")))
+        int cmp_avx512(uint32_t const *a, uint32_t const *b, size_t n) {
+            size_t i = n;
+            while (i >= 16) {
+                i -= 16;
+                __m512i x = _mm512_loadu_si512(a + i);
+                __m512i y = _mm512_loadu_si512(b + i);
+                unsigned ne = _mm512_cmpneq_epu32_mask(x, y);
+                if (ne) {
+                    size_t lane = i + 31 - static_cast<unsigned>(__builtin_clz(ne));
+                    return a[lane] < b[lane] ? -1 : 1;
+                }
+            }
+            return cmp_scalar(a, b, i);
+        }
+
+        template<typename Op>
+        __attribute__((target("avx512f")))
+        void bitwise_avx512(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                            uint32_t ma, uint32_t mb, uint32_t mr, Op op) {
+            __m512i va = _mm512_set1_epi32(static_cast<int>(ma));
+            __m512i vb = _mm512_set1_epi32(static_cast<int>(mb));
+            __m512i vr = _mm512_set1_epi32(static_cast<int>(mr));
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + i), va);
+                __m512i y = _mm512_xor_si512(_mm512_loadu_si512(b + i), vb);
+                _mm512_storeu_si512(r + i, _mm512_xor_si512(op(x, y), vr));
+            }
+            bitwise_scalar(r + i, a + i, b + i, n - i, ma, mb, mr, op);
+        }
+
+        template<typename Op>
+        void and_or_xor_avx2(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                             uint32_t ma, uint32_t mb, uint32_t mr) {
+            bitwise_avx2(r, a, b, n, ma, mb, mr, Op());
+        }
+
+        template<typename Op>
+        void and_or_xor_avx512(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n,
+                               uint32_t ma, uint32_t mb, uint32_t mr) {
+            bitwise_avx512(r, a, b, n, ma, mb, mr, Op());
+        }
+#endif
+
+        simd_kernels select_kernels() {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return {cmp_avx512, and_or_xor_avx512<and_simd>, and_or_xor_avx512<or_simd>,
+                        and_or_xor_avx512<xor_simd>};
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return {cmp_avx2, and_or_xor_avx2<and_simd>, and_or_xor_avx2<or_simd>, and_or_xor_avx2<xor_simd>};
+            }
+#endif
+            return {cmp_scalar, and_or_xor_scalar<and_op>, and_or_xor_scalar<or_op>, and_or_xor_scalar<xor_op>};
+        }
+
+        // chosen on first use, so calls from static initializers of other files are safe
+        simd_kernels const &kernels() {
+            static simd_kernels const chosen = select_kernels();
+            return chosen;
+        }
+
+        // Below this many digits the dispatch costs more than the vector loop saves
+        size_t const SIMD_MIN_SIZE = 16;
+    }
+
+    int cmp_n(uint32_t const *a, uint32_t const *b, size_t n) {
+        return n < SIMD_MIN_SIZE ? cmp_scalar(a, b, n) : kernels().cmp_n(a, b, n);
+    }
+
+    void and_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr) {
+        kernels().and_n(r, a, b, n, ma, mb, mr);
+    }
+
+    void or_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr) {
+        kernels().or_n(r, a, b, n, ma, mb, mr);
+    }
+
+    void xor_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t ma, uint32_t mb, uint32_t mr) {
+        kernels().xor_n(r, a, b, n, ma, mb, mr);
+    }
+}
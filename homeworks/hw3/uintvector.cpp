@@ -1,141 +1,266 @@
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <new>
+#include "limb_alloc.h"
 #include "uintvector.h"
 
-uintvector::bigvector::bigvector() {
-    capacity = 0;
-    data = nullptr;
-}
+namespace {
+    // Reference count policies, the buffer is freed when release() returns true
+    struct atomic_refcount {
+        std::atomic<size_t> count{1};
+
+        void acquire() { count.fetch_add(1, std::memory_order_relaxed); }
+
+        bool release() { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+        bool unique() const { return count.load(std::memory_order_acquire) == 1; }
+    };
+
+    struct plain_refcount {
+        size_t count = 1;
 
-uintvector::bigvector::bigvector(size_t cap) : capacity(cap),
-                                               data(new uint32_t[cap], std::default_delete<uint32_t[]>()) {
-    memset(data.get(), 0, cap * sizeof(uint32_t));
+        void acquire() { count++; }
+
+        bool release() { return --count == 0; }
+
+        bool unique() const { return count == 1; }
+    };
+
+#ifdef BIG_INTEGER_ATOMIC_REFCOUNT
+    typedef atomic_refcount refcount;
+#else
+    typedef plain_refcount refcount;
+#endif
 }
 
+struct uintvector::buffer {
+    refcount refs;
+    size_t capacity;
+    limb_alloc::allocator *owner;
+
+    uint32_t *digits() {
+        return reinterpret_cast<uint32_t *>(this + 1);
+    }
 
-void uintvector::bigvector::copy(const uintvector::bigvector &other) {
-    capacity = other.capacity;
-    // data = std::shared_ptr<uint32_t>(other.data);
-    data = other.data;
+    static size_t bytes(size_t capacity) {
+        return sizeof(buffer) + capacity * sizeof(uint32_t);
+    }
+
+    // the first count digits are copied from src, the rest are left uninitialized
+    static buffer *create(size_t capacity, uint32_t const *src, size_t count) {
+        limb_alloc::allocator &owner = limb_alloc::current();
+        auto *res = new(owner.allocate(bytes(capacity))) buffer{refcount(), capacity, &owner};
+        memcpy(res->digits(), src, count * sizeof(uint32_t));
+        return res;
+    }
+
+    void release() {
+        if (refs.release()) {
+            limb_alloc::allocator *from = owner;
+            size_t size = bytes(capacity);
+            this->~buffer();
+            from->deallocate(this, size);
+        }
+    }
+};
+
+uintvector::uintvector() : _size(0), is_big(false), smallvect(), vec_data(smallvect) {}
+
+uintvector::~uintvector() {
+    release();
 }
 
-uintvector::bigvector::~bigvector() = default;
+uintvector::uintvector(uintvector const &other) : _size(other._size), is_big(other.is_big) {
+    if (other.is_big && other.big) {
+        big = other.big;
+        big->refs.acquire();
+        vec_data = big->digits();
+    } else if (other.is_big) {
+        is_big = false;
+        vec_data = smallvect;
+        own_copy(other.vec_data);
+    } else {
+        vec_data = smallvect;
+        memcpy(smallvect, other.smallvect, SMALL_SIZE * sizeof(uint32_t));
+    }
+}
 
+uintvector uintvector::borrowed(uint32_t const *digits, size_t n) {
+    uintvector res;
+    res._size = n;
+    res.is_big = true;
+    res.big = nullptr;
+    // never written through: every write goes to a copy first
+    res.vec_data = const_cast<uint32_t *>(digits);
+    return res;
+}
 
-uintvector::uintvector() : bigvect() {
-    _size = 0;
-    vec_data = smallvect;
-    is_big = false;
+void uintvector::own_copy(uint32_t const *src) {
+    // this is small, src holds _size digits
+    if (_size <= SMALL_SIZE) {
+        memcpy(smallvect, src, _size * sizeof(uint32_t));
+    } else {
+        big = buffer::create(_size, src, _size);
+        is_big = true;
+        vec_data = big->digits();
+    }
 }
 
+uintvector::uintvector(uintvector &&other) noexcept : _size(0), is_big(false), vec_data(smallvect) {
+    steal(other);
+}
 
-uintvector::~uintvector() {
+void uintvector::release() {
+    // leaves this small, digits are not cleared
     if (is_big) {
-        bigvect.~bigvector();
+        if (big) {
+            big->release();
+        }
+        is_big = false;
+        vec_data = smallvect;
     }
 }
 
-uintvector::uintvector(uintvector const &other) {
+void uintvector::steal(uintvector &other) noexcept {
+    // this is small, other becomes empty and small
     _size = other._size;
     if (other.is_big) {
-        bigvect.copy(other.bigvect);
-        vec_data = bigvect.data.get();
+        big = other.big;
+        vec_data = other.vec_data;
         is_big = true;
+        other.is_big = false;
+        other.vec_data = other.smallvect;
     } else {
-        vec_data = smallvect;
-        memcpy(vec_data, other.smallvect, SMALL_SIZE * sizeof(uint32_t));
+        memcpy(smallvect, other.smallvect, SMALL_SIZE * sizeof(uint32_t));
+    }
+    other._size = 0;
+}
+
+size_t uintvector::capacity() const {
+    if (is_big) {
+        return big ? big->capacity : _size;
     }
+    return SMALL_SIZE;
+}
+
+size_t uintvector::grown_capacity(size_t sz) {
+    size_t cap = capacity();
+    return std::max(sz, 2 * cap);
+}
+
+void uintvector::reallocate(size_t cap) {
+    // moves digits into a new unshared buffer of cap digits
+    buffer *fresh = buffer::create(cap, vec_data, std::min(_size, cap));
+    release();
+    big = fresh;
+    is_big = true;
+    vec_data = big->digits();
 }
 
-size_t uintvector::get_capacity() {
-    return is_big ? bigvect.capacity : SMALL_SIZE;
+bool uintvector::is_shared() const {
+    return is_big && (!big || !big->refs.unique());
 }
 
 void uintvector::unique_copy() {
-    // called after each modification, if not unique - creates unique copy
-    if (is_big && !bigvect.data.unique()) {
-        bigvector new_vect(bigvect.capacity);
-        memcpy(new_vect.data.get(), bigvect.data.get(), bigvect.capacity * sizeof(uint32_t));
-        bigvect = new_vect;
-        vec_data = bigvect.data.get();
+    // called before each modification, if not unique - creates unique copy of the live digits
+    if (is_shared()) {
+        reallocate(capacity());
     }
 }
 
 uintvector &uintvector::operator=(uintvector const &other) {
-    _size = other._size;
+    if (this == &other) {
+        return *this;
+    }
+    if (other.is_big && !other.big) {
+        release();
+        _size = other._size;
+        own_copy(other.vec_data);
+        return *this;
+    }
     if (other.is_big) {
-        if (!is_big) {
-            memset(smallvect, 0, sizeof(uint32_t) * SMALL_SIZE);
-        }
-        bigvect.copy(other.bigvect);
-        vec_data = bigvect.data.get();
+        // taken first, so self-assignment does not free the buffer
+        other.big->refs.acquire();
+        release();
+        big = other.big;
+        vec_data = big->digits();
+        is_big = true;
     } else {
-        if (is_big) {
-            bigvect.data = nullptr;  // triggers shared_ptr
-        }
-        vec_data = smallvect;
+        release();
         memcpy(smallvect, other.smallvect, SMALL_SIZE * sizeof(uint32_t));
     }
-    is_big = other.is_big;
+    _size = other._size;
+    return *this;
+}
+
+uintvector &uintvector::operator=(uintvector &&other) noexcept {
+    if (this != &other) {
+        release();
+        steal(other);
+    }
     return *this;
 }
 
 void uintvector::resize(size_t sz) {
-    unique_copy();
-    // bool flag_was_small = get_capacity() == SMALL_SIZE;
+    if (sz > capacity()) {
+        // size is still the old one, so only valid digits are copied
+        reallocate(grown_capacity(sz));
+    } else if (sz > _size) {
+        // digits above the size become visible, they must not be shared
+        unique_copy();
+    }
     _size = sz;
-    if (_size <= get_capacity()) {
+}
+
+void uintvector::reserve(size_t cap) {
+    if (cap > capacity()) {
+        reallocate(cap);
+    }
+}
+
+void uintvector::shrink_to_fit() {
+    if (!is_big || !big || _size == big->capacity) {
         return;
     }
-    bigvector new_vect(sz);
-    memcpy(new_vect.data.get(), vec_data, sizeof(uint32_t) * get_capacity());
-    if (!is_big) {
-        is_big = true;
-        memset(smallvect, 0, sizeof(uint32_t) * SMALL_SIZE);
+    if (_size <= SMALL_SIZE) {
+        uint32_t digits[SMALL_SIZE];
+        memcpy(digits, vec_data, _size * sizeof(uint32_t));
+        release();
+        memcpy(smallvect, digits, _size * sizeof(uint32_t));
+    } else {
+        reallocate(_size);
     }
-    bigvect = new_vect;
-    vec_data = bigvect.data.get();
 }
 
+void uintvector::clear() {
+    if (is_shared()) {
+        release();
+    }
+    _size = 0;
+}
 
-uint32_t &uintvector::operator[](size_t index) const {
-    return vec_data[index];
+uint32_t *uintvector::mutable_data() {
+    unique_copy();
+    return vec_data;
 }
 
 void uintvector::pop_back() {
-    unique_copy();
     _size--;
 }
 
 void uintvector::push_back(uint32_t x) {
-    // Create unique copy if necessary
-    unique_copy();
-    // Allocation:
-    size_t old_cap = get_capacity();
-    bool flag_was_small = old_cap == SMALL_SIZE;
-    _size++;
-    if (_size > old_cap) {
-        // allocation needed
-        bigvector new_vect(2 * old_cap);
-        memcpy(new_vect.data.get(), vec_data, sizeof(uint32_t) * old_cap);
-        if (flag_was_small) {
-            is_big = true;
-            memset(smallvect, 0, sizeof(uint32_t) * SMALL_SIZE);
-        }
-        bigvect = new_vect;
-        vec_data = bigvect.data.get();
+    if (_size == capacity()) {
+        reallocate(grown_capacity(_size + 1));
+    } else {
+        unique_copy();
     }
-    // put element
-    vec_data[_size - 1] = x;
+    vec_data[_size++] = x;
 }
 
-size_t uintvector::size() const {
-    return _size;
-}
 
 uintvector &uintvector::modify(size_t index, uint32_t val) {
     unique_copy();
     vec_data[index] = val;
     return *this;
 }
-
-
@@ -3,57 +3,87 @@
 
 #include <cstdint>
 #include <cstdlib>
-#include <memory>
 
 struct uintvector {
 private:
-    struct bigvector {
-        size_t capacity;
-        std::shared_ptr<uint32_t> data;
-
-        void copy(bigvector const &other);
-
-        bigvector();
-
-        ~bigvector();
-
-        explicit bigvector(size_t cap);
-
-    };
+    // Heap digits behind a header with the reference count and capacity, one allocation
+    // from limb_alloc::current(). Counts are plain integers unless built with
+    // BIG_INTEGER_ATOMIC_REFCOUNT, then copies may be shared between threads.
+    // A big vector without a buffer borrows read-only digits of someone else.
+    struct buffer;
 
     size_t _size;
-    static const size_t SMALL_SIZE = sizeof(bigvector) / sizeof(uint32_t);
+    static const size_t SMALL_SIZE = 6;
     bool is_big;
     union {
-        bigvector bigvect;
+        buffer *big;
         uint32_t smallvect[SMALL_SIZE];
     };
     uint32_t *vec_data;
 
-    size_t get_capacity();
+    // the digits may not be written in place: a shared buffer or borrowed digits
+    bool is_shared() const;
 
     void unique_copy();
 
+    void reallocate(size_t cap);
+
+    // capacity for at least sz digits, at least twice the current one
+    size_t grown_capacity(size_t sz);
+
+    void release();
+
+    // this is small, takes its own copy of src[0.._size)
+    void own_copy(uint32_t const *src);
+
+    void steal(uintvector &other) noexcept;
+
 public:
     uintvector();
 
+    // Read-only digits[0..n) owned by the caller, nothing is copied: they must outlive the vector
+    // and its moves. Copies get their own digits, so do writes.
+    static uintvector borrowed(uint32_t const *digits, size_t n);
+
     uintvector(uintvector const &other);
 
+    uintvector(uintvector &&other) noexcept;
+
     ~uintvector();
 
     uintvector &operator=(uintvector const &other);
 
+    uintvector &operator=(uintvector &&other) noexcept;
+
     void push_back(uint32_t x);
 
     void pop_back();
 
+    // digits above the old size are unspecified, capacity grows geometrically
     void resize(size_t sz);
 
+    // capacity for at least cap digits, the size is kept
+    void reserve(size_t cap);
+
+    // gives back spare capacity, back to the inline digits if they are enough
+    void shrink_to_fit();
+
+    // size becomes 0, an unshared buffer is kept for reuse
+    void clear();
+
+    size_t capacity() const;
+
     uintvector &modify(size_t index, uint32_t val);
 
-    uint32_t &operator[](size_t index) const;
+    uint32_t &operator[](size_t index) const { return vec_data[index]; }
+
+    uint32_t const *data() const { return vec_data; }
+
+    // Creates unique copy if necessary, pointer is valid until next reallocation.
+    // Kernels take it once and write through it instead of calling modify per digit.
+    uint32_t *mutable_data();
 
-    size_t size() const;
+    size_t size() const { return _size; }
 
 };
 